@@ -7,8 +7,10 @@ OUTPUT_DIRECTORY="out"
 set -e
 
 # Check code style.
-clang-format --dry-run --Werror src/*.cpp include/*.hpp
-black --check --line-length 80 python/main.py python/moire_converter.py
+clang-format --dry-run --Werror src/*.cpp include/*.hpp include/*.h
+black --check --line-length 80 \
+    python/main.py python/moire_converter.py python/featural.py \
+    python/benchmark.py
 
 # Configure C++ code.
 mkdir -p ${BUILD_DIRECTORY}
@@ -17,8 +19,8 @@ cmake . -B ${BUILD_DIRECTORY}
 # Build C++ code into a `language` executable.
 cmake --build build
 
-# Construct TeX file, `moire_converter` will use `language` executable
-# internally.
+# Construct TeX file, `moire_converter` will use `featural` library (or
+# `language` executable if the library is not available) internally.
 mkdir -p ${OUTPUT_DIRECTORY}
 python python/moire_converter.py \
     --input data/text.moi --output ${OUTPUT_DIRECTORY}/text.tex --format tex
@@ -0,0 +1,122 @@
+#ifndef CHART_HPP
+#define CHART_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "generator.hpp"
+#include "visual.hpp"
+
+/* Page layout and output of a chart. */
+class ChartStyle {
+
+public:
+    /* Maximum number of rows and columns of a page. */
+    unsigned pageRows = 20;
+    unsigned pageColumns = 8;
+
+    /*
+     * Prefix of page files: page in row `i` and column `j` of pages is written
+     * to `<prefix><i>-<j>.tex` (or `.svg`). If empty, pages are written to the
+     * standard output.
+     */
+    std::string output;
+
+    /* Parse `key=value` descriptions, ignore descriptions without `=`. */
+    ChartStyle(std::vector<std::string> descriptions);
+};
+
+/*
+ * Parameters of a chart axis.
+ *
+ * The axis is a product of factors separated by `*`, every parameter is a
+ * combination of one item of every factor separated by `;`, the first factor
+ * varies slowest. A factor is a list of parameters separated by `,`, a file
+ * with one parameter per line (`@<path>`), or a list from the feature
+ * dictionary: `:rows` and `:columns` of the main table, `:places`,
+ * `:manners`, or `:phonations` (see `FeatureSpace`). E.g.
+ * `:manners*voiceless,voiced`.
+ */
+class ChartAxis {
+
+    /* Items of the first factor, or the file to read them from. */
+    std::vector<std::string> items;
+    std::string path;
+
+    /* Items of the other factors. */
+    std::vector<std::vector<std::string>> factors;
+
+public:
+    ChartAxis(
+        const std::string& description,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            dictionary);
+
+    /*
+     * Enumerate parameters lazily.
+     *
+     * The first factor file is read line by line while parameters are
+     * requested, so only the other factors are kept in memory.
+     */
+    Generator<std::string> parameters() const;
+};
+
+/*
+ * Feature dictionary for chart axes: rows and columns of the main table,
+ * places, manners, and phonations.
+ */
+std::unordered_map<std::string, std::vector<std::string>> getChartDictionary(
+    const std::string& graphsPath, const std::string& tablesPath);
+
+/*
+ * Draw a table in pages and write every page as soon as it is drawn.
+ *
+ * Pages are tables of at most `pageRows` × `pageColumns` cells, in row-major
+ * order, each one is a self-contained picture with its own row and column
+ * headers. Rows are read one page at a time, and columns are enumerated again
+ * for every row of pages, so memory is bounded by the page size. Graphs and
+ * IPA symbols of the page are loaded from the data index. The filter `*`
+ * shows all cells with IPA symbols. Returns the number of pages.
+ */
+unsigned drawChart(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const ChartAxis& rows,
+    const ChartAxis& columns,
+    const std::vector<std::string>& filter,
+    PainterStyle painterStyle,
+    ChartStyle chartStyle);
+
+/* Phoneme inventory of a language. */
+class Inventory {
+
+public:
+    std::string name;
+    std::vector<std::string> symbols;
+};
+
+/*
+ * Parse inventories file: every line is a language name followed by its IPA
+ * symbols, separated by spaces. Lines starting with `#` are comments. Names
+ * are used as file names, so they can't contain `/`.
+ */
+std::vector<Inventory> parseInventories(const std::string& path);
+
+/*
+ * Draw the main table filtered by every inventory and write it to
+ * `<directory>/<name>.tex` (or `.svg`) as a self-contained picture.
+ *
+ * Glyphs of all cells shown by any inventory are computed once into a shared
+ * immutable `GlyphCache`, then the tables are laid out and written by
+ * `threadCount` threads with work stealing. Returns the number of glyphs.
+ */
+size_t drawInventoryCharts(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const std::vector<Inventory>& inventories,
+    PainterStyle painterStyle,
+    const std::string& directory,
+    unsigned threadCount);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "symbol.hpp"
+
+/*
+ * Axes of the consonant feature space.
+ *
+ * Places are column parameters of the main consonants table (e.g.
+ * `labial;dental`) and graph features that consist of vertical and diagonal
+ * elements only. Phonations are row parameters of the main table that follow
+ * the manner (e.g. `voiced`). All other graph features are manners.
+ */
+class FeatureSpace {
+
+public:
+    std::vector<std::string> places;
+    std::vector<std::string> manners;
+    std::vector<std::string> phonations;
+
+    FeatureSpace(
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs,
+        IpaSymbols* ipaSymbols);
+
+    /* Cartesian product of places, manners, and phonations. */
+    std::vector<std::string> getCombinations();
+};
+
+/* Symbol of a feature combination and hashes of its geometry. */
+class Glyph {
+
+public:
+    std::string parameters;
+    std::string ipaSymbol;
+
+    /* Visible primitives of the symbol and hash of their geometry. */
+    std::vector<Primitive> primitives;
+    size_t hash;
+
+    /* Hashes of the symbol geometry with one of the primitives removed. */
+    std::vector<size_t> reducedHashes;
+};
+
+/* Text representation of the glyph: parameters and IPA symbol if any. */
+std::string getGlyphName(const Glyph& glyph);
+
+/*
+ * Render symbols for feature combinations and hash their geometry.
+ *
+ * Work is distributed between `threadCount` threads.
+ */
+std::vector<Glyph> computeGlyphs(
+    std::vector<std::string> combinations,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    IpaSymbols* ipaSymbols,
+    unsigned threadCount);
+
+/*
+ * Write collisions and near-collisions of glyphs.
+ *
+ * Glyphs collide if they have the same geometry. Glyphs near-collide if their
+ * geometry differs by exactly one primitive: one primitive is added, removed,
+ * or replaced. Returns the number of collisions.
+ */
+unsigned checkGlyphs(const std::vector<Glyph>& glyphs, std::ostream& output);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CONTAINER_HPP
+#define CONTAINER_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+/*
+ * Sequence with fixed capacity stored inline, without heap allocation.
+ *
+ * Adding more than `Capacity` values throws `std::length_error`. Values are
+ * default-constructed up to the capacity, so `T` should be cheap to construct.
+ */
+template <typename T, size_t Capacity>
+class InlineVector {
+
+    std::array<T, Capacity> values;
+    size_t count = 0;
+
+public:
+    void push_back(const T& value) {
+        if (count == Capacity) {
+            throw std::length_error(
+                "Capacity of " + std::to_string(Capacity)
+                + " values is exceeded.");
+        }
+        values[count++] = value;
+    }
+
+    size_t size() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+    T* data() {
+        return values.data();
+    }
+    const T* data() const {
+        return values.data();
+    }
+    const T& operator[](size_t index) const {
+        return values[index];
+    }
+
+    T* begin() {
+        return values.data();
+    }
+    T* end() {
+        return values.data() + count;
+    }
+    const T* begin() const {
+        return values.data();
+    }
+    const T* end() const {
+        return values.data() + count;
+    }
+};
+
+#endif
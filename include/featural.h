@@ -0,0 +1,109 @@
+#ifndef FEATURAL_H
+#define FEATURAL_H
+
+/*
+ * C API of the featural alphabet library.
+ *
+ * Rendering functions write output into a caller-provided buffer and return
+ * the full size of the output in bytes. If the returned size is greater than
+ * the buffer size, the output is truncated and the call should be repeated
+ * with a larger buffer. The output is not null-terminated. On error functions
+ * return -1, and `featural_error` returns the error message.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parsed graphs and IPA symbols table. */
+typedef struct FeaturalData FeaturalData;
+
+/*
+ * Load graphs file (e.g. `data/graphs.txt`) and consonants file (e.g.
+ * `data/consonants.txt`). Returns null on error.
+ */
+FeaturalData* featural_load(const char* graphsPath, const char* tablesPath);
+
+/* Free data returned by `featural_load`. */
+void featural_free(FeaturalData* data);
+
+/*
+ * Render TikZ code of a symbol.
+ *
+ * Parameters are the same as the arguments of the `symbol` command: element
+ * descriptors and `key=value` style parameters.
+ */
+long featural_render_symbol(
+    const char* const* parameters,
+    size_t parameterCount,
+    char* buffer,
+    size_t bufferSize);
+
+/*
+ * Render TikZ code of a phonetic table.
+ *
+ * Parameters are the same as the arguments of the `table` command: rows,
+ * columns, and filter, separated by `,`.
+ */
+long featural_render_table(
+    FeaturalData* data,
+    const char* rows,
+    const char* columns,
+    const char* filter,
+    char* buffer,
+    size_t bufferSize);
+
+/*
+ * Find inventory cells matching the expression.
+ *
+ * The expression is the same as the argument of the `query` command. Output
+ * is one line per cell: IPA symbol and sorted parameters separated by space.
+ */
+long featural_query(
+    FeaturalData* data,
+    const char* expression,
+    char* buffer,
+    size_t bufferSize);
+
+/*
+ * Time of rendering stages in seconds and sizes, accumulated in the current
+ * thread.
+ */
+typedef struct FeaturalProfile {
+    /* Parsing of data files and symbol parameters. */
+    double parsing;
+    /* Construction of primitives: elements, transformations, layout. */
+    double geometry;
+    /* Writing primitives as TikZ code. */
+    double formatting;
+    /* Number of profiled rendering calls, primitives, and output bytes. */
+    unsigned long calls;
+    unsigned long primitives;
+    unsigned long outputSize;
+} FeaturalProfile;
+
+/*
+ * Enable or disable profiling of rendering calls in the current thread.
+ *
+ * Loading time with profiling enabled is counted as parsing. With profiling,
+ * primitives are recorded before they are written, which makes rendering a
+ * bit slower.
+ */
+void featural_set_profiling(int enabled);
+
+/* Copy accumulated profile of the current thread. */
+void featural_get_profile(FeaturalProfile* profile);
+
+/* Reset accumulated profile of the current thread. */
+void featural_reset_profile(void);
+
+/* Message of the last error occurred in the current thread. */
+const char* featural_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef FILTER_HPP
+#define FILTER_HPP
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "query.hpp"
+
+/*
+ * Filter of table cells.
+ *
+ * The filter is a list of items:
+ *   - IPA symbol, e.g. `p`: cells with this symbol;
+ *   - `@` and a query expression over features of cell parameters and element
+ *     descriptors prefixed with `#` (see `QueryExpression` and
+ *     `InventoryIndex`), e.g. `@voiced&!lateral_fricative`;
+ *   - `>`, `>=`, `<`, or `<=` and a frequency of the IPA symbol as a phoneme,
+ *     in percents with `%` or as a fraction, e.g. `>5%` or `>0.05`.
+ *
+ * A cell passes if it matches any symbol or expression and all frequency
+ * thresholds. If there are only thresholds, they are applied to all cells with
+ * IPA symbols, so `>5%` shows segments present in more than 5% of languages.
+ * Frequencies are read from the phoneme frequency file written by
+ * `python/main.py`, only if there are thresholds; symbols missing in the file
+ * have frequency 0.
+ */
+class TableFilter {
+
+    class Threshold {
+
+    public:
+        bool isGreater;
+        bool isStrict;
+        float frequency;
+
+        bool passes(float value) const;
+    };
+
+    std::unordered_set<std::string> symbols;
+    std::vector<QueryExpression> expressions;
+    std::vector<Threshold> thresholds;
+
+    /* Frequency of phonemes, loaded only if there are thresholds. */
+    std::unordered_map<std::string, float> frequencies;
+
+public:
+    /* Parse the items, throw `std::invalid_argument` on syntax errors. */
+    TableFilter(
+        const std::vector<std::string>& items,
+        const std::string& frequencyPath = "out/phoneme_frequency.txt");
+
+    /*
+     * Compile the filter for the cells of a table: set of cell indices
+     * (row by row) that pass. Cell IPA symbols are in the same order. Throw
+     * `std::invalid_argument` for query terms that are not features or
+     * descriptors of the graphs.
+     */
+    Bitset compile(
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& rows,
+        const std::vector<std::string>& cellSymbols,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs) const;
+};
+
+#endif
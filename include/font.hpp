@@ -0,0 +1,74 @@
+#ifndef FONT_HPP
+#define FONT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "symbol.hpp"
+
+/* First code point of the private use area, the first symbol is mapped to. */
+constexpr uint32_t FONT_FIRST_CODE_POINT = 0xE000;
+
+/* Font units per em. */
+constexpr int FONT_UNITS_PER_EM = 1000;
+
+/*
+ * Font units per symbol unit: the symbol square [-1, 1] × [-1, 1] is 600
+ * units high and stands on the baseline.
+ */
+constexpr int FONT_UNITS_PER_SYMBOL = 300;
+
+/* Point of a glyph contour: on the outline or a quadratic control point. */
+class ContourPoint {
+
+public:
+    Vector point;
+    bool isOnCurve = true;
+};
+
+/* Closed glyph contour, clockwise for filled areas. */
+using Contour = std::vector<ContourPoint>;
+
+/*
+ * Filled outline of the stroke of a line or a cubic Bezier curve.
+ *
+ * The stroke center line is flattened, offset by `halfWidth` to both sides,
+ * and closed with round caps made of quadratic arcs. The contour is clockwise,
+ * so that overlapping strokes of a glyph are joined by the non-zero fill rule,
+ * which also makes joins round.
+ */
+Contour outlineStroke(const Primitive& primitive, float halfWidth);
+
+/* Glyph of a font: contours and advance width in font units. */
+class FontGlyph {
+
+public:
+    uint32_t codePoint;
+    std::vector<Contour> contours;
+    int advance;
+};
+
+/*
+ * Create font glyph of the symbol.
+ *
+ * Strokes are outlined with the symbol style line width relative to the size
+ * of table symbols. The advance is the ink width and one line width, like
+ * `SymbolMetrics::advance`.
+ */
+FontGlyph
+createFontGlyph(const Symbol& symbol, SymbolStyle style, uint32_t codePoint);
+
+/*
+ * Write TrueType font with the glyphs.
+ *
+ * Besides the glyphs, the font has an empty `.notdef` glyph and a space. The
+ * `cmap` table maps code points of the glyphs, which should be increasing, and
+ * the space.
+ */
+void writeFont(
+    const std::string& path,
+    const std::string& familyName,
+    const std::vector<FontGlyph>& glyphs);
+
+#endif
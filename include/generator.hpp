@@ -0,0 +1,108 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+/*
+ * Lazy sequence of values produced by a coroutine with `co_yield`.
+ *
+ * The coroutine runs only when the next value is requested, so a consumer can
+ * stop early, and nothing is computed for the values it skips. A value is valid
+ * until the iterator is incremented. The generator can be iterated once.
+ */
+template <typename T>
+class Generator {
+
+public:
+    class promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    class promise_type {
+
+    public:
+        const T* value = nullptr;
+        std::exception_ptr exception;
+
+        Generator get_return_object() {
+            return Generator(Handle::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        // The yielded temporary lives until the coroutine is resumed.
+        std::suspend_always yield_value(const T& yielded) noexcept {
+            value = std::addressof(yielded);
+            return {};
+        }
+        void return_void() { }
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+    };
+
+    class Iterator {
+
+        Handle handle;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator(Handle handle) : handle(handle) { }
+
+        const T& operator*() const {
+            return *handle.promise().value;
+        }
+        Iterator& operator++() {
+            resume(handle);
+            return *this;
+        }
+        bool operator==(std::default_sentinel_t) const {
+            return handle.done();
+        }
+    };
+
+    Generator(Generator&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr)) { }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    ~Generator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    Iterator begin() {
+        resume(handle);
+        return Iterator(handle);
+    }
+    std::default_sentinel_t end() {
+        return std::default_sentinel;
+    }
+
+private:
+    Handle handle;
+
+    explicit Generator(Handle handle) : handle(handle) { }
+
+    /* Run the coroutine to the next value, rethrow its exception if any. */
+    static void resume(Handle handle) {
+        handle.resume();
+        if (handle.promise().exception) {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
+};
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef GEOMETRY_HPP
 #define GEOMETRY_HPP
 
+#include <cstddef>
+#include <functional>
+
 /* Checks if two floating point numbers are approximately equal. */
 bool equals(float x, float y);
 
@@ -13,21 +16,133 @@ public:
 
     Vector();
     Vector(float x, float y);
-    Vector operator*(float p);
-    Vector operator+(Vector other);
-    Vector operator-(Vector other);
+    Vector operator*(float p) const;
+    Vector operator+(Vector other) const;
+    Vector operator-(Vector other) const;
+
+    /* Checks if two vectors are equal. */
+    bool operator==(Vector other) const;
+};
+
+/*
+ * 2D affine transform.
+ *
+ * Point `(x, y)` is transformed into `(a x + c y + e, b x + d y + f)`.
+ */
+class Transform {
+
+public:
+    float a = 1.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float d = 1.0f;
+    float e = 0.0f;
+    float f = 0.0f;
+
+    Transform();
+    Transform(float a, float b, float c, float d, float e, float f);
+
+    static Transform translation(Vector shift);
+    static Transform scale(float factor);
+
+    /* Shift points horizontally by `slant` of their height. */
+    static Transform skew(float slant);
+
+    /* Composition: `other` is applied first, then this transform. */
+    Transform operator*(Transform other) const;
+
+    Vector apply(Vector point) const;
+
+    /* Transform points in place, several points at once if SIMD is enabled. */
+    void apply(Vector* points, size_t count) const;
+};
+
+/* Axis-aligned bounding box. */
+class BoundingBox {
+
+public:
+    Vector minimum;
+    Vector maximum;
+    bool isEmpty = true;
 
-    /* Checks if two vectors approximately equal. */
-    bool operator==(Vector other);
+    /* Extend the box to contain the point. */
+    void add(Vector point);
+
+    /*
+     * Extend the box to contain the cubic Bezier curve.
+     *
+     * Extrema are found analytically, so the box is tight, not the box of the
+     * control points.
+     */
+    void addCurve(Vector point1, Vector point2, Vector point3, Vector point4);
+
+    /* Extend the box by the distance in all directions. */
+    void pad(float distance);
+
+    float getWidth() const;
+    float getHeight() const;
+};
+
+/* Distance from the point to the segment. */
+float getDistanceToSegment(Vector point, Vector start, Vector end);
+
+/*
+ * Distance from the point to the cubic Bezier curve.
+ *
+ * The closest parameter is found by sampling the curve and refined with
+ * Newton's method on the derivative of the squared distance.
+ */
+float getDistanceToCurve(
+    Vector point, Vector point1, Vector point2, Vector point3, Vector point4);
+
+/* Number of fixed-point units in one grid unit. */
+constexpr int GRID_SCALE = 1000;
+
+/*
+ * 2D vector with fixed-point coordinates.
+ *
+ * Coordinates are integers in `1 / GRID_SCALE` of the grid unit, so that
+ * comparisons are exact and vectors can be hashed. Symbol geometry is computed
+ * with these vectors and converted to `Vector` only when it is drawn.
+ */
+class GridVector {
+
+public:
+    int x;
+    int y;
+
+    GridVector();
+    GridVector(int x, int y);
+
+    /* Multiply by fixed-point number: `GRID_SCALE` means 1. */
+    GridVector operator*(int p) const;
+    GridVector operator+(GridVector other) const;
+    GridVector operator-(GridVector other) const;
+    bool operator==(GridVector other) const;
 
     /* Check whether vectors are grid aligned and parallel. */
-    bool isGridParallelTo(Vector other);
+    bool isGridParallelTo(GridVector other) const;
 
     /* Check whether vectors are grid aligned and codirected. */
-    bool isGridCodirectedTo(Vector other);
+    bool isGridCodirectedTo(GridVector other) const;
 
     /* Check whether vertors are orthogonal. */
-    bool isOrthogonalTo(Vector other);
+    bool isOrthogonalTo(GridVector other) const;
+
+    /* Convert to floating point vector in grid units. */
+    Vector toVector() const;
+
+    /* Round floating point vector in grid units. */
+    static GridVector fromVector(Vector vector);
+};
+
+template <>
+struct std::hash<GridVector> {
+    size_t operator()(GridVector vector) const {
+        return std::hash<long long> {}(
+            (static_cast<long long>(vector.x) << 32)
+            ^ static_cast<unsigned>(vector.y));
+    }
 };
 
 #endif
@@ -0,0 +1,156 @@
+#ifndef HIT_HPP
+#define HIT_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry.hpp"
+#include "symbol.hpp"
+#include "visual.hpp"
+
+/* Item of `HitGrid` closest to a point. */
+class GridHit {
+
+public:
+    unsigned owner;
+    float distance;
+};
+
+/*
+ * Uniform grid over bounding boxes of lines and curves.
+ *
+ * Every item is registered in all grid cells its box overlaps, so that a query
+ * tests only items in the cells around the point. Grid cells are hashed by
+ * their coordinates, so the grid is unbounded, and items can be added and
+ * removed at any time.
+ */
+class HitGrid {
+
+    class Item {
+
+    public:
+        PrimitiveType type;
+        Vector points[4];
+        BoundingBox box;
+        unsigned owner = 0;
+        bool isRemoved = false;
+    };
+
+    float cellSize;
+    std::vector<Item> items;
+    std::vector<unsigned> freeItems;
+    std::unordered_map<uint64_t, std::vector<unsigned>> cells;
+
+    /* Call the function with keys of the grid cells the box overlaps. */
+    template <typename Function>
+    void forEachCell(const BoundingBox& box, Function function) const;
+
+public:
+    HitGrid(float cellSize);
+
+    /*
+     * Add line or curve with the owner and return the item index. Other
+     * primitives can't be hit and are not added (`std::invalid_argument`).
+     */
+    unsigned add(const Primitive& primitive, unsigned owner);
+
+    /* Remove the item, its index may be reused by the next `add`. */
+    void remove(unsigned item);
+
+    /*
+     * Item closest to the point, if its distance is not greater than
+     * `maximumDistance`. Distances to lines and curves are exact.
+     */
+    std::optional<GridHit>
+    findClosest(Vector point, float maximumDistance) const;
+};
+
+/* Part of a table under a point. */
+class TableHit {
+
+public:
+    unsigned row;
+    unsigned column;
+
+    /* IPA symbol of the cell, ` ` if the cell is empty or filtered out. */
+    std::string ipaSymbol;
+
+    /*
+     * Index of the element in the cell symbol, or -1 if no element is close
+     * enough, then the descriptor and the feature are empty.
+     */
+    int element = -1;
+
+    /* Element descriptor (e.g. `hbo`) and the feature it encodes. */
+    std::string descriptor;
+    std::string feature;
+
+    /* Distance to the stroke center line of the element. */
+    float distance = 0.0f;
+};
+
+/*
+ * Index of a rendered table for hit testing, e.g. under the cursor of an
+ * editor.
+ *
+ * Cells are found by binary search of the borders. Element strokes of cell
+ * symbols are stored in a `HitGrid`, every item is owned by a cell and an
+ * element, and the element maps back to its descriptor and the feature from
+ * the graphs file.
+ */
+class TableHitIndex {
+
+    std::vector<std::string> columns;
+    std::vector<std::string> rows;
+    TableLayout layout;
+    HitGrid grid;
+
+    /* Descriptor and feature of every element by cell. */
+    std::vector<std::vector<std::pair<std::string, std::string>>>
+        cellElements;
+
+    /* Grid items by cell, for updates. */
+    std::vector<std::vector<unsigned>> cellItems;
+
+    void addCellSymbol(
+        unsigned row,
+        unsigned column,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs);
+
+public:
+    /* Layout and symbols are the same as `drawTable` with these arguments. */
+    TableHitIndex(
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& rows,
+        const std::vector<std::string>& filter,
+        IpaSymbols* ipaSymbols,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs);
+
+    const TableLayout& getLayout() const;
+
+    /*
+     * Find the element within `maximumDistance` from the point, or the cell
+     * that contains the point. Empty if the point is outside the table.
+     */
+    std::optional<TableHit> find(Vector point, float maximumDistance) const;
+
+    /*
+     * Replace items of the cell symbol with the symbol of the updated graphs.
+     *
+     * Only the items of this cell are changed. Cell borders are kept, so if
+     * the new symbol doesn't fit the cell, the table should be drawn and
+     * indexed again.
+     */
+    void updateCell(
+        unsigned row,
+        unsigned column,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs);
+};
+
+#endif
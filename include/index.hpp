@@ -0,0 +1,115 @@
+#ifndef INDEX_HPP
+#define INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "symbol.hpp"
+
+/* Modification time, size, and content hash of an index source file. */
+struct SourceStamp {
+    int64_t modified;
+    uint64_t size;
+    uint64_t hash;
+};
+
+/* Position of an index section: byte offset and number of entries. */
+struct IndexSection {
+    uint64_t offset;
+    uint64_t count;
+};
+
+/*
+ * Key and value of an index entry, both are ranges of the strings section.
+ */
+struct IndexEntry {
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+};
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    SourceStamp graphs;
+    SourceStamp tables;
+    IndexSection strings;
+    IndexSection graphEntries;
+    IndexSection cellEntries;
+    IndexSection columnEntries;
+    IndexSection rowEntries;
+};
+
+/*
+ * Compiled binary index of the graphs and consonants files.
+ *
+ * The index is stored next to the consonants file as `featural.index` and is
+ * memory-mapped, so a lookup touches only the pages it reads. Graph features
+ * and IPA cells are sorted by key and found by binary search. The index is
+ * rebuilt when the size of a source file changes, or when its modification
+ * time changes together with its content hash. If the index can't be written,
+ * it is kept in memory.
+ */
+class DataIndex {
+
+    std::string path;
+    const char* data = nullptr;
+    size_t size = 0;
+    bool isMapped = false;
+    std::string buffer;
+
+    const IndexHeader& header() const;
+    std::string_view getString(uint32_t offset, uint32_t length) const;
+    bool find(
+        IndexSection section,
+        std::string_view key,
+        std::string_view& value) const;
+    std::vector<std::string> getKeys(IndexSection section) const;
+    bool open(
+        const std::string& graphsPath,
+        const std::string& tablesPath,
+        SourceStamp& graphs,
+        SourceStamp& tables);
+    void build(
+        const std::string& graphsPath,
+        const std::string& tablesPath,
+        SourceStamp graphs,
+        SourceStamp tables);
+
+    /* Replace the index file with the content, report but ignore errors. */
+    void store(const std::string& content) const;
+
+public:
+    DataIndex(const std::string& graphsPath, const std::string& tablesPath);
+    ~DataIndex();
+    DataIndex(const DataIndex&) = delete;
+    DataIndex& operator=(const DataIndex&) = delete;
+
+    /* Find descriptors of the graph feature, return false if it's unknown. */
+    bool findGraph(
+        std::string_view feature, std::vector<std::string>& result) const;
+
+    /* IPA symbol for sorted parameters or ` ` if there is no symbol. */
+    std::string findSymbol(std::string_view key) const;
+
+    /* Column and row parameters of the main (first) table. */
+    std::vector<std::string> getColumns() const;
+    std::vector<std::string> getRows() const;
+
+    /* Graphs of the features used in the parameters separated by `;`. */
+    std::unordered_map<std::string, std::vector<std::string>>
+    loadGraphs(const std::vector<std::string>& parameters) const;
+
+    /* IPA symbols of all combinations of the columns and the rows. */
+    IpaSymbols* loadSymbols(
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& rows) const;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "visual.hpp"
+
+/*
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ *
+ * Capacity should be a power of two. Blocking `push` and `pop` sleep on the
+ * index of the other thread with `std::atomic::wait` instead of spinning, and
+ * every index update notifies the other thread.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+
+    static_assert((Capacity & (Capacity - 1)) == 0);
+
+    std::array<T, Capacity> items;
+
+    // Indices only grow, producer and consumer own one index each.
+    alignas(64) std::atomic<size_t> head = 0;
+    alignas(64) std::atomic<size_t> tail = 0;
+
+public:
+    /* Add item to the queue, return false if the queue is full. */
+    bool tryPush(T& item) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[currentTail % Capacity] = std::move(item);
+        tail.store(currentTail + 1, std::memory_order_release);
+        tail.notify_one();
+        return true;
+    }
+
+    /* Take item from the queue, return false if the queue is empty. */
+    bool tryPop(T& item) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(items[currentHead % Capacity]);
+        head.store(currentHead + 1, std::memory_order_release);
+        head.notify_one();
+        return true;
+    }
+
+    /* Add item to the queue, block while the queue is full. */
+    void push(T& item) {
+        while (not tryPush(item)) {
+            size_t currentHead = head.load(std::memory_order_acquire);
+            if (tail.load(std::memory_order_relaxed) - currentHead
+                == Capacity) {
+                head.wait(currentHead, std::memory_order_acquire);
+            }
+        }
+    }
+
+    /* Take item from the queue, block while the queue is empty. */
+    void pop(T& item) {
+        while (not tryPop(item)) {
+            size_t currentTail = tail.load(std::memory_order_acquire);
+            if (currentTail == head.load(std::memory_order_relaxed)) {
+                tail.wait(currentTail, std::memory_order_acquire);
+            }
+        }
+    }
+};
+
+/* Time a pipeline stage spent working and waiting for other stages. */
+class StageTime {
+
+public:
+    std::chrono::steady_clock::duration busy {};
+    std::chrono::steady_clock::duration waiting {};
+};
+
+/*
+ * Painter that draws in three threads connected by lock-free queues.
+ *
+ * The calling thread computes geometry and sends batches of primitives to the
+ * format thread. The format thread converts batches into TikZ or SVG code and
+ * sends it to the write thread, which writes it to the file descriptor with
+ * large `write` calls. If a queue is full, the stage that fills it waits
+ * (backpressure). After `end`, the output is completely written, and stage
+ * utilization is reported to the standard error stream.
+ */
+class PipelinePainter final : public Painter {
+
+    static const size_t BATCH_SIZE = 256;
+    static const size_t QUEUE_SIZE = 64;
+    static const size_t WRITE_SIZE = 1 << 16;
+
+    std::string format;
+    int fileDescriptor;
+
+    std::vector<Primitive> batch;
+    SpscQueue<std::vector<Primitive>, QUEUE_SIZE> batches;
+    SpscQueue<std::string, QUEUE_SIZE> chunks;
+
+    std::thread formatThread;
+    std::thread writeThread;
+
+    std::chrono::steady_clock::time_point start;
+    StageTime geometryTime;
+    StageTime formatTime;
+    StageTime writeTime;
+    size_t primitiveCount = 0;
+    size_t batchCount = 0;
+    size_t byteCount = 0;
+    size_t writeCount = 0;
+    bool isEnded = false;
+
+    void add(Primitive primitive);
+    void sendBatch();
+    void formatBatches();
+    void writeChunks();
+    void writeBuffer(const std::string& buffer);
+
+public:
+    PipelinePainter(std::string format, int fileDescriptor);
+    ~PipelinePainter();
+    std::string getString();
+    void end();
+    void line(Vector point1, Vector point2, const std::string& settings);
+    void curve(
+        Vector point1,
+        Vector point2,
+        Vector point3,
+        Vector point4,
+        const std::string& settings);
+    void
+    text(Vector center, const std::string& text, const std::string& settings);
+    void rectangle(Vector point1, Vector point2, const std::string& settings);
+};
+
+#endif
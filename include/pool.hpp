@@ -0,0 +1,43 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/*
+ * Threads that run tasks with work stealing.
+ *
+ * Every thread has its own deque of task indices: it takes tasks from the
+ * front of its deque, and when the deque is empty, it steals from the back of
+ * the deques of other threads. So threads that got cheap tasks help the ones
+ * that got expensive tasks, without a shared queue all threads contend for.
+ */
+class WorkStealingPool {
+
+    class Worker {
+
+    public:
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    unsigned threadCount;
+
+    /* Take a task of the worker, or steal one; false if all are taken. */
+    bool takeTask(std::vector<Worker>& workers, unsigned worker, size_t& task);
+
+public:
+    WorkStealingPool(unsigned threadCount);
+
+    /*
+     * Call the function for every task index in [0, count) and wait until all
+     * tasks are done. The calling thread is one of the threads. If tasks throw,
+     * the first exception is rethrown after all threads finish.
+     */
+    void run(size_t count, const std::function<void(size_t)>& task);
+};
+
+#endif
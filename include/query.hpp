@@ -0,0 +1,138 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "symbol.hpp"
+
+/*
+ * Set of indices in [0, size) stored as bits.
+ *
+ * Set operations process 128 bits at once if SIMD is enabled.
+ */
+class Bitset {
+
+    size_t size = 0;
+    std::vector<uint64_t> words;
+
+public:
+    Bitset(size_t size = 0);
+
+    /* Set with all indices. */
+    static Bitset full(size_t size);
+
+    size_t getSize() const;
+    void set(size_t index);
+    bool test(size_t index) const;
+
+    /* Number of indices in the set. */
+    size_t count() const;
+
+    /* Indices in increasing order. */
+    std::vector<size_t> getIndices() const;
+
+    // Set operations with a set of the same size.
+    Bitset& operator&=(const Bitset& other);
+    Bitset& operator|=(const Bitset& other);
+    Bitset& andNot(const Bitset& other);
+
+    /* Complement in [0, size). */
+    Bitset& flip();
+};
+
+/*
+ * Boolean expression over terms.
+ *
+ * Terms are combined with `and`, `or`, `not` (or `&`, `|`, `!`) and
+ * parentheses; `not` binds tighter than `and`, which binds tighter than `or`.
+ * A term is any other sequence of characters without spaces and parentheses.
+ * E.g. `voiced and (lateral_fricative or lateral_approximant)`.
+ */
+class QueryExpression {
+
+    enum class NodeType { Term, Not, And, Or };
+
+    class Node {
+
+    public:
+        NodeType type;
+        std::string term;
+        unsigned left = 0;
+        unsigned right = 0;
+    };
+
+    std::vector<Node> nodes;
+    unsigned root = 0;
+
+    Bitset evaluate(
+        unsigned node,
+        const std::function<Bitset(const std::string&)>& getTerm,
+        size_t size) const;
+
+public:
+    /* Parse the expression, throw `std::invalid_argument` on syntax errors. */
+    QueryExpression(const std::string& text);
+
+    /* All terms of the expression. */
+    std::vector<std::string> getTerms() const;
+
+    /*
+     * Evaluate the expression. Sets of terms are requested from `getTerm`,
+     * all sets should have the `size`.
+     */
+    Bitset evaluate(
+        const std::function<Bitset(const std::string&)>& getTerm,
+        size_t size) const;
+};
+
+/*
+ * Query terms of cell parameters separated by `;`: the features and the
+ * element descriptors of their graphs prefixed with `#`.
+ */
+std::vector<std::string> getCellTerms(
+    const std::string& parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs);
+
+/* Check whether the term is a feature or a `#` descriptor of the graphs. */
+bool isKnownTerm(
+    const std::string& term,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs);
+
+/*
+ * Inverted index of inventory cells: cells of the consonants file with IPA
+ * symbols.
+ *
+ * Every feature of cell parameters (e.g. `voiced`) and every element
+ * descriptor of its glyph prefixed with `#` (e.g. `#hbo`) is mapped to the
+ * set of cells that have it.
+ */
+class InventoryIndex {
+
+    /* Sorted parameters and IPA symbols of cells. */
+    std::vector<std::string> cells;
+    std::vector<std::string> ipaSymbols;
+
+    std::unordered_map<std::string, Bitset> postings;
+
+public:
+    InventoryIndex(
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs,
+        const IpaSymbols& symbols);
+
+    size_t size() const;
+    const std::string& getCell(size_t index) const;
+    const std::string& getIpaSymbol(size_t index) const;
+
+    /* Cells of the term, throw `std::invalid_argument` for unknown terms. */
+    const Bitset& getTermCells(const std::string& term) const;
+
+    /* Cells matching the expression, see `QueryExpression`. */
+    Bitset query(const QueryExpression& expression) const;
+};
+
+#endif
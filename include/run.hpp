@@ -0,0 +1,54 @@
+#ifndef RUN_HPP
+#define RUN_HPP
+
+#include <string>
+#include <vector>
+
+#include "symbol.hpp"
+#include "visual.hpp"
+
+/*
+ * Layout settings of a glyph run.
+ *
+ * Spacing and line height are in symbol sizes (zoomed `size`).
+ */
+class RunStyle {
+
+public:
+    /* Symbol size: half of the symbol square side. */
+    float size = 0.1f;
+
+    /* Target line width, lines are not broken if it is 0. */
+    float width = 0.0f;
+
+    float letterSpacing = 0.4f;
+    float wordSpacing = 1.5f;
+    float lineHeight = 3.0f;
+
+    /* Parse `key=value` descriptions, ignore descriptions without `=`. */
+    RunStyle(std::vector<std::string> descriptions);
+};
+
+/*
+ * Parse words of a run.
+ *
+ * Glyphs of a word are separated by `,`, descriptors of a glyph are separated
+ * by spaces. E.g. `vl ht,hbo vc`.
+ */
+std::vector<std::vector<Symbol>> parseRun(std::vector<std::string> words);
+
+/*
+ * Lay out words in lines and draw them in one pass.
+ *
+ * Glyphs are placed by their advance widths, lines are broken between words
+ * when they exceed the target width. All glyphs share the symbol style, its
+ * stroke settings are defined once as the `featural` style. The first line is
+ * centered at `y = 0` and starts at `x = 0`.
+ */
+void drawRun(
+    Painter* painter,
+    const std::vector<std::vector<Symbol>>& words,
+    SymbolStyle style,
+    RunStyle runStyle);
+
+#endif
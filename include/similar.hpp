@@ -0,0 +1,119 @@
+#ifndef SIMILAR_HPP
+#define SIMILAR_HPP
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "symbol.hpp"
+
+/* Number of cells along a side of the coverage grid. */
+constexpr unsigned COVERAGE_GRID_SIZE = 8;
+
+/* Number of stroke orientation bins in [0, π). */
+constexpr unsigned ORIENTATION_BIN_COUNT = 8;
+
+/* Length of the feature vector, a multiple of 4 for SIMD kernels. */
+constexpr unsigned FEATURE_SIZE
+    = COVERAGE_GRID_SIZE * COVERAGE_GRID_SIZE + ORIENTATION_BIN_COUNT;
+static_assert(FEATURE_SIZE % 4 == 0);
+
+using FeatureVector = std::array<float, FEATURE_SIZE>;
+
+/*
+ * Visual features of the symbol.
+ *
+ * Visible strokes are split into short segments. Segment lengths are spread
+ * bilinearly over a coarse coverage grid of the symbol square and added to
+ * the histogram of stroke orientations. Both parts are normalized by the
+ * total stroke length, so that the vector doesn't depend on the symbol size.
+ */
+FeatureVector getFeatureVector(const Symbol& symbol);
+
+/* Squared Euclidean distance between feature vectors. */
+float getDistance(const float* vector1, const float* vector2);
+
+/* Glyph found by a similarity query. */
+class Neighbor {
+
+public:
+    unsigned index;
+    float distance;
+};
+
+/* Pair of glyphs and the distance between them. */
+class SimilarPair {
+
+public:
+    unsigned first;
+    unsigned second;
+    float distance;
+};
+
+/*
+ * Index of glyph feature vectors for similarity search.
+ *
+ * Vectors are stored contiguously and compared by brute force with SIMD
+ * distance kernels, which is fast enough for the whole feature space.
+ */
+class SimilarityIndex {
+
+    std::vector<std::string> names;
+    std::vector<float> vectors;
+
+public:
+    void add(const std::string& name, const FeatureVector& vector);
+    size_t size() const;
+    const std::string& getName(unsigned index) const;
+
+    /* The `k` glyphs nearest to the vector, nearest first. */
+    std::vector<Neighbor> findNearest(const FeatureVector& vector, unsigned k)
+        const;
+
+    /* The `count` closest pairs of different glyphs, closest first. */
+    std::vector<SimilarPair> findClosestPairs(unsigned count) const;
+};
+
+/*
+ * Similarity index of glyphs of feature combinations.
+ *
+ * Combinations with equal feature vectors are grouped into one entry of the
+ * index, named by all of them: `<glyph> = <glyph>`.
+ */
+class GlyphGroups {
+
+    SimilarityIndex index;
+    size_t combinationCount = 0;
+
+    /* Group of every combination by sorted parameters. */
+    std::unordered_map<std::string, unsigned> keyToGroup;
+
+public:
+    GlyphGroups(
+        const std::vector<std::string>& combinations,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs,
+        const IpaSymbols& ipaSymbols);
+
+    const SimilarityIndex& getIndex() const;
+    size_t getCombinationCount() const;
+
+    /*
+     * Name of the glyph of the parameters: the name of its group if the
+     * parameters are one of the combinations, otherwise the parameters.
+     */
+    std::string getName(const std::string& parameters) const;
+
+    /*
+     * The `k` groups nearest to the glyph of the parameters, nearest first.
+     * The group of the parameters itself is not a neighbor.
+     */
+    std::vector<Neighbor> findNearest(
+        const std::string& parameters,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs,
+        unsigned k) const;
+};
+
+#endif
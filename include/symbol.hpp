@@ -1,11 +1,18 @@
 #ifndef SYMBOL_HPP
 #define SYMBOL_HPP
 
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "container.hpp"
+#include "generator.hpp"
 #include "visual.hpp"
 
+/* See `filter.hpp`, a list of IPA symbols converts to a filter. */
+class TableFilter;
+
 /*
  * Describes a graphical element of a symbol.
  *
@@ -39,6 +46,15 @@ enum class ElementDescriptor {
     Unknown
 };
 
+/* Direction of a symbol element line. */
+enum class ElementDirection : uint8_t {
+    None,
+    Horizontal,
+    Vertical,
+    Slash,
+    Backslash
+};
+
 /* Sort parameters sequence separated by `;`. */
 std::string sortParameters(std::string parameters);
 
@@ -54,7 +70,43 @@ public:
     bool curveDiagonal = true;
     bool isHandwritten = false;
 
+    /* Horizontal shift of the symbol points by their height (italic). */
+    float slant = 0.0f;
+
     SymbolStyle(std::vector<std::string> description);
+
+    /*
+     * Transform from the symbol space to the plane: skew, zoom and `size`,
+     * style position, and `center`.
+     */
+    Transform getTransform(Vector center, float size) const;
+
+    /*
+     * Transform of the point with the index in element primitives. Handwritten
+     * symbols shift and scale every control point differently before the
+     * symbol transform, otherwise it is the symbol transform.
+     */
+    Transform getTransform(Vector center, float size, unsigned point) const;
+
+    /* Painter settings of element strokes. */
+    std::string getStrokeSettings() const;
+};
+
+/* TeX points in a centimeter: line width is in points, the plane is in cm. */
+constexpr float POINTS_PER_CM = 72.27f / 2.54f;
+
+/* Extents of a symbol in the plane, relative to its center. */
+class SymbolMetrics {
+
+public:
+    /* Box of the ink: stroke center lines padded by half of the line width. */
+    BoundingBox ink;
+
+    /* Half of the line width. */
+    float strokeExtent = 0.0f;
+
+    /* Width the symbol occupies in a line of text: ink and one line width. */
+    float advance = 0.0f;
 };
 
 /*
@@ -80,58 +132,94 @@ public:
  */
 class Element {
 
-    std::vector<ElementDescriptor> elementDescriptors;
-    Vector indirectedNorm = Vector();
-    float position = 0;
-    Vector direction = Vector();
-    float pointOffset1 = -1;
-    float pointOffset2 = 1;
+    // Packed geometry: position and offsets are in grid units (-1, 0, or 1),
+    // vectors are computed from them, see `getDirection`.
+    ElementDirection direction = ElementDirection::None;
+    int8_t position = 0;
+    int8_t pointOffset1 = -1;
+    int8_t pointOffset2 = 1;
+
+    bool isDouble : 1 = false;
+    bool isCurved : 1 = false;
+    bool isPointed : 1 = false;
+    bool isInwards : 1 = false;
+    bool isDiagonal : 1 = false;
+
+    /* Unit vector of the direction in fixed-point units. */
+    GridVector getDirection() const;
 
-    bool isDouble = false;
-    bool isCurved = false;
-    bool isPointed = false;
-    bool isInwards = false;
-    bool isDiagonal = false;
+    /* Norm of the line through the center: direction rotated by 90°. */
+    GridVector getIndirectedNorm() const;
 
-    Vector getNorm();
-    Vector getPoint1();
-    Vector getPoint2();
+    GridVector getNorm() const;
+    GridVector getPoint1() const;
+    GridVector getPoint2() const;
 
 public:
     void add(ElementDescriptor elementDescriptor);
-    void draw(
-        Painter* painter,
+    Generator<Primitive> primitives(
         SymbolStyle style,
-        Vector center,
-        float size,
-        Vector step,
-        std::vector<Element> elements);
-
-    /* Draw symbol element. */
-    void draw(
-        Painter* painter,
-        SymbolStyle style,
-        Vector center,
-        float size,
-        std::vector<Element> elements);
+        GridVector step,
+        std::span<const Element> elements) const;
+
+    /* Primitives of the element in the symbol space: [-1, 1] × [-1, 1]. */
+    Generator<Primitive> primitives(
+        SymbolStyle style, std::span<const Element> elements) const;
 };
 
+static_assert(sizeof(Element) <= 8);
+
+/* Maximum number of elements of a symbol. */
+constexpr size_t MAX_SYMBOL_ELEMENTS = 16;
+
 /*
  * Symbol of an alphabet.
  *
- * It consists of elements: lines and curves.
+ * It consists of elements: lines and curves. Elements are stored inline, so
+ * that symbols can be copied without allocation; a symbol with more than
+ * `MAX_SYMBOL_ELEMENTS` elements can't be constructed (`std::length_error`).
  */
 class Symbol {
 
-    std::vector<Element> elements;
+    InlineVector<Element, MAX_SYMBOL_ELEMENTS> elements;
     void add(Element element);
 
 public:
     /* Construct symbol from the string representation. */
     Symbol(std::vector<std::string> reprs);
 
-    /* Get graphical representation of the symbol. */
-    void draw(Painter* painter, SymbolStyle style, Vector center, float size);
+    /*
+     * Primitives of the symbol.
+     *
+     * Element primitives are computed in the symbol space, collected, and
+     * mapped to the plane in one pass over their points, see
+     * `SymbolStyle::getTransform`. The optional background rectangle comes
+     * first, the invisible line reserving the symbol height comes last.
+     */
+    Generator<Primitive> primitives(
+        SymbolStyle style, Vector center, float size) const;
+
+    /*
+     * Compute metrics from the element geometry, without drawing.
+     *
+     * Curve extrema are found analytically, so the ink box is tight.
+     */
+    SymbolMetrics getMetrics(SymbolStyle style, float size) const;
+
+    /* Number of elements, in the order of the string representations. */
+    size_t getElementCount() const;
+
+    /* Primitives of one element, mapped to the plane like in `primitives`. */
+    Generator<Primitive> elementPrimitives(
+        unsigned index, SymbolStyle style, Vector center, float size) const;
+
+    /*
+     * Get graphical representation of the symbol.
+     *
+     * Instantiated for `Painter` and concrete painters.
+     */
+    template <PainterPolicy P>
+    void draw(P& painter, SymbolStyle style, Vector center, float size) const;
 };
 
 /*
@@ -177,10 +265,11 @@ parseSymbolParameters(std::vector<std::string> parameters);
 std::unordered_map<std::string, std::vector<std::string>>
 parseGraphs(const std::string& path);
 
+template <PainterPolicy P>
 void drawTikz(
-    Painter* painter,
-    std::string ipaSymbol,
-    std::vector<std::string> reprs,
+    P& painter,
+    const std::string& ipaSymbol,
+    const std::vector<std::string>& reprs,
     Vector center);
 
 class IpaSymbols {
@@ -188,23 +277,175 @@ class IpaSymbols {
     std::unordered_map<std::string, std::string> symbols;
 
 public:
+    /* Column and row parameters of the main (first) table. */
+    std::vector<std::string> columns;
+    std::vector<std::string> rows;
+
     void add(std::string parameters, std::string ipaSymbol);
-    std::string findSymbol(std::string key);
+    std::string findSymbol(std::string key) const;
+
+    /* IPA symbols by sorted parameters. */
+    const std::unordered_map<std::string, std::string>& getSymbols() const;
 };
 
+/*
+ * Parse consonants file.
+ *
+ * The file consists of tables separated by empty lines. The first line of a
+ * table is the list of columns, every other line is a row name followed by IPA
+ * symbols for every column. Throw `std::invalid_argument` for rows of another
+ * width.
+ */
+IpaSymbols* parseTables(const std::string& path);
+
+/*
+ * Get graphical element descriptors for parameters separated by `;`.
+ *
+ * Descriptors of all parameters are concatenated, empty descriptors (`.`) are
+ * skipped.
+ */
+std::vector<std::string> getDescriptors(
+    std::string parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs);
+
 std::string parametersToTex(std::string parameters);
 
+/* Check whether the table cell value is an IPA symbol, not `-`, `=`, or ` `. */
+bool hasIpaSymbol(std::string ipaSymbol);
+
+/* Size of symbols in table cells. */
+constexpr float CELL_SYMBOL_SIZE = 0.1f;
+
+/* Horizontal shift of the symbol from the IPA symbol in table cells. */
+constexpr float CELL_SYMBOL_SHIFT = 0.5f;
+
+/*
+ * Symbol of a table cell computed in advance: descriptors, ink box, and
+ * primitives relative to the symbol center.
+ */
+class CellGlyph {
+
+public:
+    std::vector<std::string> descriptors;
+    BoundingBox ink;
+    std::vector<Primitive> primitives;
+};
+
+/* Compute the symbol of the cell with the parameters separated by `;`. */
+CellGlyph createCellGlyph(
+    const std::string& parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs);
+
+/*
+ * Symbols of table cells computed in advance, by cell parameters in the table
+ * order: column and row separated by `;`.
+ *
+ * The cache is immutable, so that several threads can draw tables with it at
+ * once.
+ */
+class GlyphCache {
+
+    std::unordered_map<std::string, CellGlyph> glyphs;
+
+public:
+    GlyphCache(std::unordered_map<std::string, CellGlyph> glyphs);
+
+    /* Glyph of the cell parameters, null if it is not cached. */
+    const CellGlyph* find(const std::string& parameters) const;
+
+    size_t size() const;
+};
+
+/*
+ * Contents of the cells of a phonetic table: symbols and descriptors.
+ *
+ * Contents are stored row by row; cells that don't pass the filter have ` `
+ * symbol and no descriptors. The filter is compiled once for the table, so a
+ * cell is tested with one bit.
+ */
+class TableCells {
+
+public:
+    std::vector<std::string> cellSymbols;
+    std::vector<std::vector<std::string>> cellDescriptors;
+
+    /* Glyphs of cells from the cache, null for cells that are not cached. */
+    std::vector<const CellGlyph*> cellGlyphs;
+
+    /* Descriptors of symbols found in the cache are not parsed again. */
+    TableCells(
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& rows,
+        const TableFilter& filter,
+        IpaSymbols* ipaSymbols,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs,
+        const GlyphCache* cache = nullptr);
+};
+
+/*
+ * Layout of a phonetic table: cell borders and contents.
+ *
+ * Cells are at least 1 × 0.5 and grow if their symbols don't fit.
+ */
+class TableLayout : public TableCells {
+
+public:
+    /* Borders of columns from `0` to the right, of rows from `-0` down. */
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> heights;
+
+    /* Symbols found in the cache are not computed again. */
+    TableLayout(
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& rows,
+        const TableFilter& filter,
+        IpaSymbols* ipaSymbols,
+        const std::unordered_map<std::string, std::vector<std::string>>&
+            graphs,
+        const GlyphCache* cache = nullptr);
+
+    /* Measure cells parsed in advance. */
+    TableLayout(
+        const std::vector<std::string>& columns,
+        const std::vector<std::string>& rows,
+        TableCells cells);
+
+    /*
+     * Center of the IPA symbol of the cell. The cell symbol is drawn
+     * `CELL_SYMBOL_SHIFT` to the right of it.
+     */
+    Vector getCellCenter(unsigned row, unsigned column) const;
+};
+
 /*
  * Draw phonetic table.
  *
- * Rows ans columns contain phonological characteristics.
+ * Rows ans columns contain phonological characteristics. The caller is
+ * responsible for calling `painter.end()` and collecting the output. Symbols
+ * of cells found in the cache are drawn from it. Instantiated for `Painter`
+ * and concrete painters.
+ *
+ * The filter may be passed as a list of items, see `TableFilter`; callers
+ * should include `filter.hpp` for the conversion.
  */
+template <PainterPolicy P>
 void drawTable(
-    Painter* painter,
-    std::vector<std::string> columns,
-    std::vector<std::string> rows,
-    std::vector<std::string> filter,
+    P& painter,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const TableFilter& filter,
     IpaSymbols* ipaSymbols,
-    std::unordered_map<std::string, std::vector<std::string>> graphs);
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    const GlyphCache* cache = nullptr);
+
+/* Draw phonetic table with cells parsed in advance. */
+template <PainterPolicy P>
+void drawTable(
+    P& painter,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const TableCells& cells);
 
 #endif
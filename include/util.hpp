@@ -6,4 +6,12 @@
 
 std::vector<std::string> split(const std::string& s, char delimiter);
 
+float parseFloat(std::string floatValue);
+
+/* Parse Boolean value: `+` or `-`. */
+bool parseBool(std::string boolValue);
+
+/* Combine hash value with another one. */
+size_t combineHash(size_t seed, size_t hash);
+
 #endif
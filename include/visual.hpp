@@ -1,14 +1,45 @@
 #ifndef VISUAL_HPP
 #define VISUAL_HPP
 
+#include <charconv>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "geometry.hpp"
 
+class Primitive;
+
+/*
+ * Type that can draw primitives on the plane.
+ *
+ * Drawing functions are templates on the painter type. With a concrete
+ * painter, calls are resolved at compile time and can be inlined. With
+ * `Painter`, they are virtual calls through the type-erased adapter.
+ */
+template <typename P>
+concept PainterPolicy = requires(
+    P& painter,
+    Vector point,
+    const std::string& string,
+    const std::vector<Primitive>& primitives) {
+    painter.line(point, point, string);
+    painter.curve(point, point, point, point, string);
+    painter.text(point, string, string);
+    painter.rectangle(point, point, string);
+    painter.glyph(point, primitives);
+};
+
 /*
  * A wrapper for a painter that can draw primitives on the plane.
  *
- * Those primitives are: lines, Bezier curves, rectangles, text.
+ * Those primitives are: lines, Bezier curves, rectangles, text. This is the
+ * type-erased painter, concrete painters are `final` so that calls are not
+ * virtual when the type is known.
  */
 class Painter {
 
@@ -18,13 +49,16 @@ protected:
 public:
     Painter() {};
     Painter(std::string path) {};
+    virtual ~Painter() {};
     virtual std::string getString() = 0;
 
     /* This method should be called in the end of drawing process. */
     virtual void end() = 0;
 
     /* Draw line between two points. */
-    virtual void line(Vector point1, Vector point2, std::string settings) = 0;
+    virtual void
+    line(Vector point1, Vector point2, const std::string& settings)
+        = 0;
 
     /* Draw cubic Bezier curve (with 2 control points). */
     virtual void curve(
@@ -32,58 +66,453 @@ public:
         Vector point2,
         Vector point3,
         Vector point4,
-        std::string settings)
+        const std::string& settings)
         = 0;
 
     /* Draw text. */
-    virtual void text(Vector center, std::string text, std::string settings)
+    virtual void
+    text(Vector center, const std::string& text, const std::string& settings)
         = 0;
 
     /* Draw axes aligned rectangle. */
-    virtual void rectangle(Vector point1, Vector point2, std::string settings)
+    virtual void
+    rectangle(Vector point1, Vector point2, const std::string& settings)
         = 0;
+
+    /*
+     * Draw glyph: primitives with coordinates relative to the position.
+     *
+     * By default primitives are drawn one by one. Painters may define every
+     * distinct glyph once and reuse the definition.
+     */
+    virtual void
+    glyph(Vector position, const std::vector<Primitive>& primitives);
+
+    /*
+     * Define named settings and return settings that refer to them.
+     *
+     * By default settings are not named and are returned as is, so that they
+     * are repeated in every primitive.
+     */
+    virtual std::string
+    defineStyle(const std::string& name, const std::string& settings);
 };
 
-/* Write TikZ code of graphical primitives. */
-class TikzPainter : public Painter {
+/* Output settings of a painter. */
+class PainterStyle {
+
+public:
+    /* Output format: `tikz` or `svg`. */
+    std::string format = "tikz";
+
+    /* Define every distinct glyph once and reuse it. */
+    bool deduplicate = false;
 
-    /* Stream to write TikZ code to. */
-    std::stringstream stream;
+    /* Draw with `PipelinePainter`, writing to the standard output. */
+    bool pipeline = false;
+
+    /* Parse `key=value` descriptions, ignore descriptions without `=`. */
+    PainterStyle(std::vector<std::string> descriptions);
+};
+
+/* Create painter for the output format. */
+Painter* createPainter(PainterStyle style);
+
+/*
+ * Glyphs a painter has defined, by glyph hash.
+ *
+ * Hashes may collide, so primitives of every defined glyph are kept and
+ * compared: a glyph with the hash of another glyph gets its own definition.
+ */
+class GlyphDefinitions {
+
+    std::unordered_map<size_t, std::vector<std::vector<Primitive>>> glyphs;
 
 public:
-    TikzPainter(std::string path);
+    /* Identifier of the glyph and whether it is new and should be defined. */
+    std::pair<std::string, bool>
+    define(const std::vector<Primitive>& primitives);
+
+    bool empty() const;
+};
+
+/* Append a piece of code as is. */
+inline void appendPiece(std::string& code, std::string_view piece) {
+    code += piece;
+}
+
+/* Append a number formatted like `std::ostream` does by default (`%g`). */
+inline void appendPiece(std::string& code, float value) {
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(
+        buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    code.append(buffer, result.ptr);
+}
+
+/*
+ * Append pieces of code: strings and numbers.
+ *
+ * Emission of primitives is defined inline with this function, so that
+ * drawing code with a concrete painter formats primitives without calls
+ * through streams.
+ */
+template <typename... Pieces>
+inline void writeCode(std::string& code, const Pieces&... pieces) {
+    (appendPiece(code, pieces), ...);
+}
+
+/*
+ * Write TikZ code of graphical primitives.
+ *
+ * If deduplication is enabled, every distinct glyph is defined once as a pic
+ * and drawn with `\pic`. Named styles are defined with `\tikzset`.
+ */
+class TikzPainter final : public Painter {
+
+    /* TikZ code of primitives. */
+    std::string code;
+
+    bool deduplicate;
+    std::stringstream definitions;
+    GlyphDefinitions definedGlyphs;
+
+public:
+    TikzPainter(std::string path, bool deduplicate = false);
     std::string getString();
     void end();
-    void line(Vector point1, Vector point2, std::string settings);
+    void line(Vector point1, Vector point2, const std::string& settings);
     void curve(
         Vector point1,
         Vector point2,
         Vector point3,
         Vector point4,
-        std::string settings);
-    void text(Vector center, std::string text, std::string settings);
-    void rectangle(Vector point1, Vector point2, std::string settings);
+        const std::string& settings);
+    void
+    text(Vector center, const std::string& text, const std::string& settings);
+    void rectangle(Vector point1, Vector point2, const std::string& settings);
+    void glyph(Vector position, const std::vector<Primitive>& primitives);
+    std::string
+    defineStyle(const std::string& name, const std::string& settings);
 };
 
-/* Write SVG code of graphical primitives. */
-class SVGPainter : public Painter {
+/*
+ * Write SVG code of graphical primitives.
+ *
+ * If deduplication is enabled, every distinct glyph is defined once as a
+ * `<symbol>` and drawn with `<use>`.
+ */
+class SVGPainter final : public Painter {
+
+    /* SVG code of primitives. */
+    std::string code;
 
-    /* Stream to write TikZ code to. */
-    std::stringstream stream;
+    bool deduplicate;
+    std::stringstream definitions;
+    GlyphDefinitions definedGlyphs;
 
 public:
-    SVGPainter(std::string path);
+    SVGPainter(std::string path, bool deduplicate = false);
     std::string getString();
     void end();
-    void line(Vector point1, Vector point2, std::string settings);
+    void line(Vector point1, Vector point2, const std::string& settings);
     void curve(
         Vector point1,
         Vector point2,
         Vector point3,
         Vector point4,
-        std::string settings);
-    void text(Vector center, std::string text, std::string settings);
-    void rectangle(Vector point1, Vector point2, std::string settings);
+        const std::string& settings);
+    void
+    text(Vector center, const std::string& text, const std::string& settings);
+    void rectangle(Vector point1, Vector point2, const std::string& settings);
+    void glyph(Vector position, const std::vector<Primitive>& primitives);
 };
 
+// Emission of primitives.
+
+inline void TikzPainter::line(
+    Vector point1, Vector point2, const std::string& settings) {
+    writeCode(
+        code,
+        "\\draw[",
+        settings,
+        "] (",
+        point1.x,
+        ", ",
+        point1.y,
+        ") -- (",
+        point2.x,
+        ", ",
+        point2.y,
+        ");\n");
+}
+
+inline void TikzPainter::curve(
+    Vector point1,
+    Vector point2,
+    Vector point3,
+    Vector point4,
+    const std::string& settings) {
+    writeCode(
+        code,
+        "\\draw[",
+        settings,
+        "] (",
+        point1.x,
+        ", ",
+        point1.y,
+        ") .. controls (",
+        point2.x,
+        ", ",
+        point2.y,
+        ") and (",
+        point3.x,
+        ", ",
+        point3.y,
+        ") .. (",
+        point4.x,
+        ", ",
+        point4.y,
+        ");\n");
+}
+
+inline void TikzPainter::text(
+    Vector center, const std::string& text, const std::string& settings) {
+    writeCode(
+        code,
+        "\\node[",
+        settings,
+        "] at (",
+        center.x,
+        ", ",
+        center.y,
+        ") {",
+        text,
+        "};\n");
+}
+
+inline void TikzPainter::rectangle(
+    Vector point1, Vector point2, const std::string& settings) {
+    writeCode(
+        code,
+        "\\draw[",
+        settings,
+        "] (",
+        point1.x,
+        ", ",
+        point1.y,
+        ") rectangle (",
+        point2.x,
+        ", ",
+        point2.y,
+        ");\n");
+}
+
+inline void SVGPainter::line(
+    Vector point1, Vector point2, const std::string& settings) {
+    writeCode(
+        code,
+        "<line \"",
+        point1.x,
+        "\" y1=\"",
+        point1.y,
+        "\" x2=\"",
+        point2.x,
+        "\" y2=\"",
+        point2.y,
+        "\" />\n");
+}
+
+inline void SVGPainter::curve(
+    Vector point1,
+    Vector point2,
+    Vector point3,
+    Vector point4,
+    const std::string& settings) {
+    writeCode(
+        code,
+        "<path d=\"M ",
+        point1.x,
+        " ",
+        point1.y,
+        "C ",
+        point2.x,
+        " ",
+        point2.y,
+        ", ",
+        point3.x,
+        " ",
+        point3.y,
+        ", ",
+        point4.x,
+        " ",
+        point4.y,
+        "\" />\n");
+}
+
+inline void SVGPainter::text(
+    Vector center, const std::string& text, const std::string& settings) {
+    writeCode(
+        code,
+        "<text x=\"",
+        center.x,
+        "\" y=\"",
+        center.y,
+        "\">",
+        text,
+        "</text>\n");
+}
+
+inline void SVGPainter::rectangle(
+    Vector point1, Vector point2, const std::string& settings) {
+    writeCode(
+        code,
+        "<rect x=\"",
+        point1.x,
+        "\" y=\"",
+        point1.y,
+        "\" width=\"",
+        point2.x - point1.x,
+        "\" height=\"",
+        point2.y - point1.x,
+        "\" />\n");
+}
+
+/* Kind of a graphical primitive. */
+enum class PrimitiveType { Line, Curve, Text, Rectangle };
+
+/*
+ * Graphical primitive: line, cubic Bezier curve, text, or rectangle.
+ *
+ * Lines and rectangles use 2 points, curves use 4 points, text uses 1 point.
+ */
+class Primitive {
+
+public:
+    PrimitiveType type;
+    Vector points[4];
+    unsigned pointCount;
+    std::string settings;
+    std::string text;
+
+    /* Draw the primitive shifted by the vector with another painter. */
+    template <PainterPolicy P>
+    void draw(P& painter, Vector shift = Vector()) const {
+        switch (type) {
+        case PrimitiveType::Line:
+            painter.line(points[0] + shift, points[1] + shift, settings);
+            break;
+        case PrimitiveType::Curve:
+            painter.curve(
+                points[0] + shift,
+                points[1] + shift,
+                points[2] + shift,
+                points[3] + shift,
+                settings);
+            break;
+        case PrimitiveType::Text:
+            painter.text(points[0] + shift, text, settings);
+            break;
+        case PrimitiveType::Rectangle:
+            painter.rectangle(points[0] + shift, points[1] + shift, settings);
+            break;
+        }
+    }
+
+    /*
+     * Hash of the primitive geometry.
+     *
+     * Coordinates are rounded to `1 / GRID_SCALE`, and curves and lines are
+     * hashed independently of their direction. Settings and text are ignored.
+     */
+    size_t getGeometryHash() const;
+};
+
+/*
+ * Draw recorded primitive as is: shifting by zero would turn `-0` coordinates
+ * into `0` and change the output.
+ */
+template <PainterPolicy P>
+void replay(const Primitive& primitive, P& painter) {
+    const Vector* points = primitive.points;
+
+    switch (primitive.type) {
+    case PrimitiveType::Line:
+        painter.line(points[0], points[1], primitive.settings);
+        break;
+    case PrimitiveType::Curve:
+        painter.curve(
+            points[0], points[1], points[2], points[3], primitive.settings);
+        break;
+    case PrimitiveType::Text:
+        painter.text(points[0], primitive.text, primitive.settings);
+        break;
+    case PrimitiveType::Rectangle:
+        painter.rectangle(points[0], points[1], primitive.settings);
+        break;
+    }
+}
+
+/* Record graphical primitives instead of writing them. */
+class RecordingPainter final : public Painter {
+
+public:
+    std::vector<Primitive> primitives;
+
+    RecordingPainter();
+    std::string getString();
+    void end();
+    void line(Vector point1, Vector point2, const std::string& settings);
+    void curve(
+        Vector point1,
+        Vector point2,
+        Vector point3,
+        Vector point4,
+        const std::string& settings);
+    void
+    text(Vector center, const std::string& text, const std::string& settings);
+    void rectangle(Vector point1, Vector point2, const std::string& settings);
+};
+
+/*
+ * Hash of geometry of primitives independent of their order.
+ *
+ * Invisible primitives (with `draw=none` settings) are ignored.
+ */
+size_t getGeometryHash(const std::vector<Primitive>& primitives);
+
+/*
+ * Check whether primitives have the same geometry as `getGeometryHash` sees
+ * it: in any order and direction, with coordinates rounded to
+ * `1 / GRID_SCALE`.
+ */
+bool isSameGeometry(
+    const std::vector<Primitive>& primitives1,
+    const std::vector<Primitive>& primitives2);
+
+/*
+ * Hash identifying the glyph for deduplication: geometry and settings of
+ * primitives.
+ */
+size_t getGlyphHash(const std::vector<Primitive>& primitives);
+
+/*
+ * Create painter for the output format and call the function with it.
+ *
+ * The function is instantiated for every concrete painter, so that drawing
+ * code calls the painter directly. `PipelinePainter` is passed as `Painter`.
+ */
+template <typename Function>
+void visitPainter(PainterStyle style, Function function) {
+    if (not style.pipeline and style.format == "tikz") {
+        TikzPainter painter("", style.deduplicate);
+        function(painter);
+    } else if (not style.pipeline and style.format == "svg") {
+        SVGPainter painter("", style.deduplicate);
+        function(painter);
+    } else {
+        std::unique_ptr<Painter> painter(createPainter(style));
+        function(*painter);
+    }
+}
+
 #endif
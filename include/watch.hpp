@@ -0,0 +1,61 @@
+#ifndef WATCH_HPP
+#define WATCH_HPP
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "symbol.hpp"
+
+/*
+ * Table requested in a watch specification file.
+ *
+ * Every non-empty line of the file is `<output> <rows> <columns> <filter>`
+ * followed by optional output options, with the same meaning as arguments of
+ * the `table` command. Lines starting with `#` are comments.
+ */
+class TableSpec {
+
+public:
+    std::string output;
+    std::vector<std::string> rows;
+    std::vector<std::string> columns;
+    std::vector<std::string> filter;
+    std::vector<std::string> options;
+
+    /* Graph features used in rows and columns. */
+    std::set<std::string> getFeatures() const;
+
+    /* Sorted parameters of all table cells. */
+    std::set<std::string> getCellKeys() const;
+};
+
+/* Parse watch specification file. */
+std::vector<TableSpec> parseTableSpecs(const std::string& path);
+
+/* Features that were added, removed, or changed. */
+std::set<std::string> getChangedFeatures(
+    const std::unordered_map<std::string, std::vector<std::string>>& oldGraphs,
+    const std::unordered_map<std::string, std::vector<std::string>>&
+        newGraphs);
+
+/* Sorted cell parameters whose IPA symbols were added, removed, or changed. */
+std::set<std::string>
+getChangedCells(const IpaSymbols& oldSymbols, const IpaSymbols& newSymbols);
+
+/*
+ * Render tables of the specification file and re-render them on changes.
+ *
+ * Parsed data is kept in memory. When the graphs or the consonants file is
+ * written, it is parsed again and compared with the previous state, and only
+ * tables that use changed features or cells are rendered. When the
+ * specification file is written, all its tables are rendered. Outputs are
+ * replaced atomically. Uses inotify, so works on Linux only. Never returns.
+ */
+void watch(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const std::string& specPath);
+
+#endif
@@ -0,0 +1,261 @@
+"""
+Benchmark of the Moire to TeX conversion of documents with symbols.
+
+Converts the shipped document and synthetic documents with many symbols and
+tables, either with the `featural` shared library or spawning `language`
+executable for every symbol and table, and reports time of the stages:
+
+  - Moire parsing: constructing intermediate representation of the document,
+  - rendering: calls of the library or `language` processes, for the library
+    split into data parsing, geometry, TikZ formatting, and the overhead of
+    the binding (ctypes calls and decoding),
+  - TeX formatting: the rest of the conversion in Python,
+
+and the output size. Every document is converted several times and the median
+time is reported. Synthetic documents are generated with a fixed seed, so that
+results are comparable between runs.
+"""
+
+import argparse
+import random
+import re
+import statistics
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Optional
+
+import moire_converter
+from featural import Featural, FeaturalProfile, library_path
+from moire_converter import LanguageTeX
+
+INPUT_PATH: Path = Path("data/text.moi")
+GRAPHS_PATH: Path = Path("data/graphs.txt")
+
+
+@dataclass
+class Measurement:
+    """Time of conversion stages in seconds and sizes."""
+
+    total: float = 0.0
+    moire_parsing: float = 0.0
+    rendering: float = 0.0
+    calls: int = 0
+    profile: Optional[FeaturalProfile] = None
+    output_size: int = 0
+
+    def tex_formatting(self) -> float:
+        return self.total - self.moire_parsing - self.rendering
+
+
+@dataclass
+class Document:
+    """Moire document to convert."""
+
+    name: str
+    text: str
+    symbols: int = 0
+    tables: int = 0
+    measurements: list[Measurement] = field(default_factory=list)
+
+
+class ProfiledTeX(LanguageTeX):
+    """TeX converter that measures time of Moire parsing and rendering."""
+
+    def __init__(self) -> None:
+        super().__init__()
+        self.measurement: Measurement = Measurement()
+
+    def get_ir(self, text: str, offset: int = 0, prefix: str = ""):
+        start: float = time.perf_counter()
+        result = super().get_ir(text, offset, prefix)
+        self.measurement.moire_parsing += time.perf_counter() - start
+        return result
+
+    def tikz_symbol(self, arg) -> str:
+        return self.measure(super().tikz_symbol, arg)
+
+    def symbol_table(self, arg) -> str:
+        return self.measure(super().symbol_table, arg)
+
+    def measure(self, function, arg) -> str:
+        start: float = time.perf_counter()
+        result: str = function(arg)
+        self.measurement.rendering += time.perf_counter() - start
+        self.measurement.calls += 1
+        return result
+
+
+def generate_document(
+    name: str, template: str, symbols: int, tables: int, seed: int
+) -> Document:
+    """Document with random symbols and copies of the table of the template.
+
+    Symbols are random combinations of element descriptors from the graphs
+    file, placed in paragraphs of text. Diagonal elements `/` and `\\` are
+    skipped, since they are special characters in Moire and symbol parameters.
+    """
+    randomizer: random.Random = random.Random(seed)
+    descriptors: list[str] = sorted(
+        {
+            descriptor
+            for line in GRAPHS_PATH.read_text().splitlines()
+            for descriptor in line.split()[1:]
+            if descriptor.isalnum()
+        }
+    )
+    table_match: Optional[re.Match] = re.search(
+        r"\\tikz \{\s*\\symbol_table.*?\n\}", template, re.DOTALL
+    )
+    if not table_match:
+        raise ValueError("No symbol table in the template.")
+
+    paragraphs: list[str] = []
+    for index in range(symbols):
+        parameters: str = " ".join(
+            randomizer.sample(descriptors, randomizer.randint(1, 4))
+        )
+        paragraphs.append(f"Symbol {index} is \\symbol {{{parameters}}}.")
+    text: str = "\n\n".join(
+        "\n".join(paragraphs[index : index + 10])
+        for index in range(0, len(paragraphs), 10)
+    )
+    text += "\n\n" + "\n\n".join([table_match.group(0)] * tables) + "\n"
+
+    return Document(name, text, symbols, tables)
+
+
+def convert(document: Document, library: Optional[Featural]) -> Measurement:
+    """Convert the document and measure time of the stages."""
+    moire_converter.featural = library
+    if library:
+        library.set_profiling(True)
+        library.reset_profile()
+
+    converter: ProfiledTeX = ProfiledTeX()
+    converter.file_name = document.name
+
+    start: float = time.perf_counter()
+    output: str = converter.convert(document.text, wrap=True)
+    converter.measurement.total = time.perf_counter() - start
+    converter.measurement.output_size = len(output.encode())
+
+    if library:
+        converter.measurement.profile = library.profile()
+        library.set_profiling(False)
+    return converter.measurement
+
+
+def median(measurements: list[Measurement], key) -> float:
+    return statistics.median(key(x) for x in measurements)
+
+
+def report(document: Document, mode: str) -> None:
+    """Print median time of the stages."""
+    measurements: list[Measurement] = document.measurements
+    total: float = median(measurements, lambda x: x.total)
+    calls: int = measurements[0].calls
+
+    def line(name: str, seconds: float) -> None:
+        share: float = 100 * seconds / total if total else 0
+        print(f"    {name:<20} {seconds * 1000:10.1f} ms {share:5.1f} %")
+
+    print(
+        f"{document.name} ({mode}): {document.symbols} symbols, "
+        f"{document.tables} tables, {calls} rendering calls, "
+        f"{measurements[0].output_size} bytes"
+    )
+    line("total", total)
+    line("Moire parsing", median(measurements, lambda x: x.moire_parsing))
+    if mode == "spawn":
+        line("process spawns", median(measurements, lambda x: x.rendering))
+    else:
+        line("rendering", median(measurements, lambda x: x.rendering))
+        line(
+            "  data parsing", median(measurements, lambda x: x.profile.parsing)
+        )
+        line("  geometry", median(measurements, lambda x: x.profile.geometry))
+        line(
+            "  TikZ formatting",
+            median(measurements, lambda x: x.profile.formatting),
+        )
+        line(
+            "  binding overhead",
+            median(
+                measurements,
+                lambda x: x.rendering
+                - x.profile.parsing
+                - x.profile.geometry
+                - x.profile.formatting,
+            ),
+        )
+        print(f"    {'primitives':<20} {measurements[0].profile.primitives:10}")
+    line("TeX formatting", median(measurements, lambda x: x.tex_formatting()))
+
+
+def main() -> None:
+    parser: argparse.ArgumentParser = argparse.ArgumentParser(
+        description="Benchmark Moire to TeX conversion."
+    )
+    parser.add_argument("--input", type=Path, default=INPUT_PATH)
+    parser.add_argument("--build", type=Path, default=Path("build"))
+    parser.add_argument(
+        "--mode", choices=["library", "spawn", "both"], default="library"
+    )
+    parser.add_argument(
+        "--symbols",
+        type=int,
+        nargs="*",
+        default=[1000, 5000],
+        help="number of symbols in synthetic documents",
+    )
+    parser.add_argument("--tables", type=int, default=20)
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--seed", type=int, default=0)
+    options: argparse.Namespace = parser.parse_args()
+
+    template: str = options.input.read_text()
+    documents: list[Document] = [
+        Document(
+            str(options.input),
+            template,
+            template.count("\\symbol {") + template.count("\\tikz_symbol {"),
+            template.count("\\symbol_table"),
+        )
+    ]
+    for symbols in options.symbols:
+        documents.append(
+            generate_document(
+                f"synthetic-{symbols}",
+                template,
+                symbols,
+                options.tables,
+                options.seed,
+            )
+        )
+    moire_converter.SYMBOL_GENERATOR_EXECUTABLE = str(
+        options.build / "language"
+    )
+    modes: list[str] = (
+        ["library", "spawn"] if options.mode == "both" else [options.mode]
+    )
+    for mode in modes:
+        library: Optional[Featural] = None
+        if mode == "library":
+            start: float = time.perf_counter()
+            library = Featural(library_path(options.build))
+            print(
+                f"Library loaded in "
+                f"{(time.perf_counter() - start) * 1000:.1f} ms."
+            )
+        for document in documents:
+            # Spawning is slow, so it is measured once.
+            repetitions: int = options.repetitions if library else 1
+            document.measurements = [
+                convert(document, library) for _ in range(repetitions)
+            ]
+            report(document, mode)
+
+
+if __name__ == "__main__":
+    main()
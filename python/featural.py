@@ -0,0 +1,154 @@
+"""
+In-process binding to the `featural` shared library.
+
+Rendering functions return a memory view of the internal output buffer, so no
+copy is made. The view is valid until the next rendering call.
+"""
+
+import ctypes
+import sys
+from pathlib import Path
+
+BUILD_DIRECTORY: Path = Path("build")
+GRAPHS_PATH: Path = Path("data/graphs.txt")
+TABLES_PATH: Path = Path("data/consonants.txt")
+INITIAL_BUFFER_SIZE: int = 64 * 1024
+
+
+class FeaturalProfile(ctypes.Structure):
+    """Time of rendering stages in seconds and sizes, see `featural.h`."""
+
+    _fields_ = [
+        ("parsing", ctypes.c_double),
+        ("geometry", ctypes.c_double),
+        ("formatting", ctypes.c_double),
+        ("calls", ctypes.c_ulong),
+        ("primitives", ctypes.c_ulong),
+        ("output_size", ctypes.c_ulong),
+    ]
+
+
+def library_path(build_directory: Path = BUILD_DIRECTORY) -> Path:
+    """Path to the shared library built by CMake."""
+    if sys.platform == "darwin":
+        return build_directory / "libfeatural.dylib"
+    if sys.platform == "win32":
+        return build_directory / "featural.dll"
+    return build_directory / "libfeatural.so"
+
+
+class Featural:
+    """Loaded library with parsed graphs and IPA symbols table."""
+
+    def __init__(
+        self,
+        path: Path = library_path(),
+        graphs_path: Path = GRAPHS_PATH,
+        tables_path: Path = TABLES_PATH,
+    ) -> None:
+        self.library: ctypes.CDLL = ctypes.CDLL(str(path))
+
+        self.library.featural_load.restype = ctypes.c_void_p
+        self.library.featural_load.argtypes = [ctypes.c_char_p] * 2
+        self.library.featural_free.argtypes = [ctypes.c_void_p]
+        self.library.featural_render_symbol.restype = ctypes.c_long
+        self.library.featural_render_symbol.argtypes = [
+            ctypes.POINTER(ctypes.c_char_p),
+            ctypes.c_size_t,
+            ctypes.c_void_p,
+            ctypes.c_size_t,
+        ]
+        self.library.featural_render_table.restype = ctypes.c_long
+        self.library.featural_render_table.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_char_p,
+            ctypes.c_char_p,
+            ctypes.c_char_p,
+            ctypes.c_void_p,
+            ctypes.c_size_t,
+        ]
+        self.library.featural_query.restype = ctypes.c_long
+        self.library.featural_query.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_char_p,
+            ctypes.c_void_p,
+            ctypes.c_size_t,
+        ]
+        self.library.featural_set_profiling.argtypes = [ctypes.c_int]
+        self.library.featural_get_profile.argtypes = [
+            ctypes.POINTER(FeaturalProfile)
+        ]
+        self.library.featural_error.restype = ctypes.c_char_p
+
+        self.data: int = self.library.featural_load(
+            str(graphs_path).encode(), str(tables_path).encode()
+        )
+        if not self.data:
+            raise RuntimeError(self.error())
+
+        self.buffer: bytearray = bytearray(INITIAL_BUFFER_SIZE)
+
+    def __del__(self) -> None:
+        if getattr(self, "data", None):
+            self.library.featural_free(self.data)
+            self.data = None
+
+    def error(self) -> str:
+        """Message of the last error."""
+        return self.library.featural_error().decode()
+
+    def render(self, function, *arguments) -> memoryview:
+        """Call rendering function, grow the buffer if output doesn't fit."""
+        while True:
+            size: int = len(self.buffer)
+            pointer = (ctypes.c_char * size).from_buffer(self.buffer)
+            result: int = function(*arguments, pointer, size)
+            del pointer
+            if result < 0:
+                raise RuntimeError(self.error())
+            if result <= size:
+                return memoryview(self.buffer)[:result]
+            self.buffer = bytearray(result)
+
+    def symbol(self, parameters: list[str]) -> memoryview:
+        """TikZ code of a symbol, same as `language symbol` output."""
+        array = (ctypes.c_char_p * len(parameters))(
+            *[x.encode() for x in parameters]
+        )
+        return self.render(
+            self.library.featural_render_symbol, array, len(parameters)
+        )
+
+    def table(self, rows: str, columns: str, filter_: str) -> memoryview:
+        """TikZ code of a table, same as `language table` output."""
+        return self.render(
+            self.library.featural_render_table,
+            self.data,
+            rows.encode(),
+            columns.encode(),
+            filter_.encode(),
+        )
+
+    def query(self, expression: str) -> list[tuple[str, str]]:
+        """IPA symbols and parameters of cells matching the expression."""
+        output: memoryview = self.render(
+            self.library.featural_query, self.data, expression.encode()
+        )
+        return [
+            tuple(line.split(" ", 1))
+            for line in output.tobytes().decode().splitlines()
+        ]
+
+    def set_profiling(self, enabled: bool) -> None:
+        """Enable or disable profiling of rendering stages."""
+        self.library.featural_set_profiling(int(enabled))
+
+    def profile(self) -> FeaturalProfile:
+        """Accumulated time of rendering stages."""
+        result: FeaturalProfile = FeaturalProfile()
+        self.library.featural_get_profile(ctypes.byref(result))
+        return result
+
+    def reset_profile(self) -> None:
+        """Reset accumulated time of rendering stages."""
+        self.library.featural_reset_profile()
@@ -1,6 +1,8 @@
+from featural import Featural
 from moire.default import Default, DefaultTeX
 from moire.main import main
 from textwrap import dedent
+from typing import Optional
 import subprocess
 import sys
 
@@ -8,6 +10,19 @@ import sys
 SYMBOL_GENERATOR_EXECUTABLE: str = "build/language"
 
 
+def load_featural() -> Optional[Featural]:
+    """Load the shared library, return `None` if it is not built."""
+    try:
+        return Featural()
+    except OSError:
+        return None
+
+
+# If the shared library is available, symbols are rendered in-process,
+# otherwise `language` executable is spawned for every symbol.
+featural: Optional[Featural] = load_featural()
+
+
 class Language(Default):
     def figure(self, arg) -> str:
         raise NotImplementedError()
@@ -137,6 +152,8 @@ class LanguageTeX(Language, DefaultTeX):
         return f"{{\\ru{{{self.parse(arg[0])}}}}}"
 
     def tikz_symbol(self, arg) -> str:
+        if featural:
+            return str(featural.symbol(self.clear(arg[0]).split(" ")), "utf-8")
         proc: subprocess.Popen = subprocess.Popen(
             [SYMBOL_GENERATOR_EXECUTABLE, "symbol"]
             + self.clear(arg[0]).split(" "),
@@ -153,6 +170,8 @@ class LanguageTeX(Language, DefaultTeX):
         filter_: str = ""
         if len(arg) > 2:
             filter_ = arg[2][0].strip().replace("\n", ",").replace(" ", ",")
+        if featural:
+            return str(featural.table(rows, columns, filter_), "utf-8")
         proc: subprocess.Popen = subprocess.Popen(
             [SYMBOL_GENERATOR_EXECUTABLE, "table", rows, columns, filter_],
             stdout=subprocess.PIPE,
@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "chart.hpp"
+#include "check.hpp"
+#include "filter.hpp"
+#include "index.hpp"
+#include "pool.hpp"
+#include "symbol.hpp"
+#include "util.hpp"
+
+/* Parse the number of rows or columns of a page, it should be positive. */
+static unsigned parsePageSize(const std::string& value) {
+    int size = std::stoi(value);
+    if (size <= 0) {
+        throw std::invalid_argument("Page should have at least one cell.");
+    }
+    return size;
+}
+
+ChartStyle::ChartStyle(std::vector<std::string> descriptions) {
+    for (std::string description : descriptions) {
+
+        if (description.find('=') == std::string::npos) {
+            continue;
+        }
+        std::vector<std::string> keyValue = split(description, '=');
+        std::string key = keyValue[0];
+        std::string value = keyValue.size() > 1 ? keyValue[1] : "";
+
+        if (key == "pr") {
+            pageRows = parsePageSize(value);
+        } else if (key == "pc") {
+            pageColumns = parsePageSize(value);
+        } else if (key == "o") {
+            output = value;
+        }
+    }
+}
+
+/* Read non-empty lines of the file. */
+static std::vector<std::string> readLines(const std::string& path) {
+
+    std::ifstream file(path);
+    if (not file.is_open()) {
+        throw std::invalid_argument("Could not open the file " + path + ".");
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (not line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+ChartAxis::ChartAxis(
+    const std::string& description,
+    const std::unordered_map<std::string, std::vector<std::string>>&
+        dictionary) {
+
+    std::vector<std::string> factorDescriptions = split(description, '*');
+    if (factorDescriptions.empty()) {
+        throw std::invalid_argument("Empty chart axis.");
+    }
+    for (unsigned i = 0; i < factorDescriptions.size(); i++) {
+        std::string factor = factorDescriptions[i];
+        std::vector<std::string> factorItems;
+
+        if (factor[0] == '@' and i == 0) {
+            // Check the file now, it is read later.
+            path = factor.substr(1);
+            if (not std::ifstream(path).is_open()) {
+                throw std::invalid_argument(
+                    "Could not open the file " + path + ".");
+            }
+            continue;
+        } else if (factor[0] == '@') {
+            factorItems = readLines(factor.substr(1));
+        } else if (factor[0] == ':') {
+            if (not dictionary.contains(factor.substr(1))) {
+                throw std::invalid_argument(
+                    "Unknown chart axis factor `" + factor + "`.");
+            }
+            factorItems = dictionary.at(factor.substr(1));
+        } else {
+            factorItems = split(factor, ',');
+        }
+        if (factorItems.empty()) {
+            throw std::invalid_argument(
+                "Chart axis factor `" + factor + "` is empty.");
+        }
+        if (i == 0) {
+            items = factorItems;
+        } else {
+            factors.push_back(factorItems);
+        }
+    }
+}
+
+Generator<std::string> ChartAxis::parameters() const {
+
+    std::ifstream file;
+    if (not path.empty()) {
+        file.open(path);
+        if (not file.is_open()) {
+            throw std::invalid_argument(
+                "Could not open the file " + path + ".");
+        }
+    }
+    std::vector<size_t> indices(factors.size(), 0);
+    size_t next = 0;
+    std::string item;
+
+    while (true) {
+        if (path.empty()) {
+            if (next == items.size()) {
+                break;
+            }
+            item = items[next++];
+        } else {
+            if (not std::getline(file, item)) {
+                break;
+            }
+            if (item.empty()) {
+                continue;
+            }
+        }
+        // Enumerate the other factors like digits of a number.
+        while (true) {
+            std::string parameter = item;
+            for (unsigned i = 0; i < factors.size(); i++) {
+                parameter += ";" + factors[i][indices[i]];
+            }
+            co_yield parameter;
+
+            size_t i = factors.size();
+            while (i > 0 and ++indices[i - 1] == factors[i - 1].size()) {
+                indices[i - 1] = 0;
+                i--;
+            }
+            if (i == 0) {
+                break;
+            }
+        }
+    }
+}
+
+std::unordered_map<std::string, std::vector<std::string>> getChartDictionary(
+    const std::string& graphsPath, const std::string& tablesPath) {
+
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = parseGraphs(graphsPath);
+    std::unique_ptr<IpaSymbols> ipaSymbols(parseTables(tablesPath));
+    FeatureSpace space(graphs, ipaSymbols.get());
+
+    return {
+        {"rows", ipaSymbols->rows},
+        {"columns", ipaSymbols->columns},
+        {"places", space.places},
+        {"manners", space.manners},
+        {"phonations", space.phonations}};
+}
+
+/* Wrap drawing code into a self-contained picture. */
+static std::string
+wrapPicture(const std::string& code, const PainterStyle& painterStyle) {
+    if (painterStyle.format == "svg") {
+        return "<svg xmlns=\"http://www.w3.org/2000/svg\">\n" + code
+            + "</svg>\n";
+    }
+    return "\\begin{tikzpicture}\n" + code + "\\end{tikzpicture}\n";
+}
+
+static void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content;
+    file.close();
+    if (file.fail()) {
+        throw std::invalid_argument("Could not write the file " + path);
+    }
+}
+
+/* Draw the page as a self-contained picture. */
+static std::string drawPage(
+    const DataIndex& index,
+    const std::vector<std::string>& rows,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& filter,
+    PainterStyle painterStyle) {
+
+    std::vector<std::string> parameters = rows;
+    parameters.insert(parameters.end(), columns.begin(), columns.end());
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = index.loadGraphs(parameters);
+    std::unique_ptr<IpaSymbols> ipaSymbols(index.loadSymbols(columns, rows));
+
+    std::vector<std::string> pageFilter = filter;
+    if (std::find(filter.begin(), filter.end(), "*") != filter.end()) {
+        for (auto& [key, ipaSymbol] : ipaSymbols->getSymbols()) {
+            pageFilter.push_back(ipaSymbol);
+        }
+    }
+    std::string page;
+    visitPainter(painterStyle, [&](auto& painter) {
+        drawTable(
+            painter, columns, rows, pageFilter, ipaSymbols.get(), graphs);
+        painter.end();
+        page = painter.getString();
+    });
+    return wrapPicture(page, painterStyle);
+}
+
+unsigned drawChart(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const ChartAxis& rows,
+    const ChartAxis& columns,
+    const std::vector<std::string>& filter,
+    PainterStyle painterStyle,
+    ChartStyle chartStyle) {
+
+    DataIndex index(graphsPath, tablesPath);
+
+    // Pages are collected as strings.
+    painterStyle.pipeline = false;
+    std::string extension = painterStyle.format == "svg" ? ".svg" : ".tex";
+
+    unsigned pageCount = 0;
+    unsigned rowPage = 0;
+    std::vector<std::string> pageRows;
+
+    auto writePage = [&](const std::vector<std::string>& pageColumns,
+                         unsigned columnPage) {
+        std::string page
+            = drawPage(index, pageRows, pageColumns, filter, painterStyle);
+
+        if (chartStyle.output.empty()) {
+            std::cout << page << std::flush;
+        } else {
+            std::string path = chartStyle.output + std::to_string(rowPage)
+                + "-" + std::to_string(columnPage) + extension;
+            writeFile(path, page);
+        }
+        pageCount++;
+    };
+    auto writeRowOfPages = [&]() {
+        unsigned columnPage = 0;
+        std::vector<std::string> pageColumns;
+        for (const std::string& column : columns.parameters()) {
+            pageColumns.push_back(column);
+            if (pageColumns.size() == chartStyle.pageColumns) {
+                writePage(pageColumns, columnPage++);
+                pageColumns.clear();
+            }
+        }
+        if (not pageColumns.empty()) {
+            writePage(pageColumns, columnPage);
+        }
+        pageRows.clear();
+        rowPage++;
+    };
+
+    for (const std::string& row : rows.parameters()) {
+        pageRows.push_back(row);
+        if (pageRows.size() == chartStyle.pageRows) {
+            writeRowOfPages();
+        }
+    }
+    if (not pageRows.empty()) {
+        writeRowOfPages();
+    }
+    return pageCount;
+}
+
+std::vector<Inventory> parseInventories(const std::string& path) {
+
+    std::vector<Inventory> inventories;
+
+    for (const std::string& line : readLines(path)) {
+        if (line[0] == '#') {
+            continue;
+        }
+        std::istringstream stream(line);
+        Inventory inventory;
+        if (not(stream >> inventory.name)) {
+            continue;
+        }
+        if (inventory.name.find('/') != std::string::npos) {
+            throw std::invalid_argument(
+                "Inventory name " + inventory.name + " contains `/`.");
+        }
+        std::string symbol;
+        while (stream >> symbol) {
+            inventory.symbols.push_back(symbol);
+        }
+        inventories.push_back(inventory);
+    }
+    return inventories;
+}
+
+size_t drawInventoryCharts(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const std::vector<Inventory>& inventories,
+    PainterStyle painterStyle,
+    const std::string& directory,
+    unsigned threadCount) {
+
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = parseGraphs(graphsPath);
+    std::unique_ptr<IpaSymbols> ipaSymbols(parseTables(tablesPath));
+    const std::vector<std::string>& columns = ipaSymbols->columns;
+    const std::vector<std::string>& rows = ipaSymbols->rows;
+
+    // Cells of the main table shown by any inventory, with parameters in the
+    // order `drawTable` uses.
+    std::unordered_set<std::string> symbols;
+    for (const Inventory& inventory : inventories) {
+        symbols.insert(inventory.symbols.begin(), inventory.symbols.end());
+    }
+    std::vector<std::string> cells;
+    for (const std::string& row : rows) {
+        for (const std::string& column : columns) {
+            std::string parameters = column + ";" + row;
+            std::string ipaSymbol
+                = ipaSymbols->findSymbol(sortParameters(parameters));
+            if (symbols.contains(ipaSymbol)) {
+                cells.push_back(parameters);
+            }
+        }
+    }
+
+    // Compute every glyph once, then only read the cache.
+    WorkStealingPool pool(threadCount);
+    std::vector<CellGlyph> glyphs(cells.size());
+    pool.run(cells.size(), [&](size_t i) {
+        glyphs[i] = createCellGlyph(cells[i], graphs);
+    });
+    std::unordered_map<std::string, CellGlyph> cachedGlyphs;
+    for (size_t i = 0; i < cells.size(); i++) {
+        cachedGlyphs.emplace(cells[i], std::move(glyphs[i]));
+    }
+    const GlyphCache cache(std::move(cachedGlyphs));
+
+    // Tables are collected as strings.
+    painterStyle.pipeline = false;
+    std::string extension = painterStyle.format == "svg" ? ".svg" : ".tex";
+    std::filesystem::create_directories(directory);
+
+    pool.run(inventories.size(), [&](size_t i) {
+        std::string table;
+        visitPainter(painterStyle, [&](auto& painter) {
+            drawTable(
+                painter,
+                columns,
+                rows,
+                inventories[i].symbols,
+                ipaSymbols.get(),
+                graphs,
+                &cache);
+            painter.end();
+            table = painter.getString();
+        });
+        writeFile(
+            directory + "/" + inventories[i].name + extension,
+            wrapPicture(table, painterStyle));
+    });
+    return cache.size();
+}
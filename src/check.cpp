@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "check.hpp"
+#include "symbol.hpp"
+#include "util.hpp"
+#include "visual.hpp"
+
+/* Check whether graph feature consists of vertical and diagonal elements. */
+static bool isPlace(std::vector<std::string> descriptors) {
+    if (descriptors.empty()) {
+        return false;
+    }
+    for (std::string descriptor : descriptors) {
+        if (descriptor.empty()
+            or (descriptor[0] != 'v' and descriptor[0] != '/'
+                and descriptor[0] != '\\')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool contains(std::vector<std::string> values, std::string value) {
+    return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+FeatureSpace::FeatureSpace(
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    IpaSymbols* ipaSymbols) {
+
+    // Sort features to get the same combinations on every run.
+    std::set<std::string> features;
+    for (auto& [feature, descriptors] : graphs) {
+        features.insert(feature);
+    }
+
+    std::vector<std::string> placeFeatures;
+    for (std::string column : ipaSymbols->columns) {
+        places.push_back(column);
+        for (std::string feature : split(column, ';')) {
+            placeFeatures.push_back(feature);
+        }
+    }
+    for (std::string feature : features) {
+        if (isPlace(graphs.at(feature)) and not contains(places, feature)) {
+            places.push_back(feature);
+            placeFeatures.push_back(feature);
+        }
+    }
+    for (std::string row : ipaSymbols->rows) {
+        std::vector<std::string> rowFeatures = split(row, ';');
+        for (unsigned i = 1; i < rowFeatures.size(); i++) {
+            if (not contains(placeFeatures, rowFeatures[i])
+                and not contains(phonations, rowFeatures[i])) {
+                phonations.push_back(rowFeatures[i]);
+            }
+        }
+    }
+    for (std::string feature : features) {
+        if (not contains(placeFeatures, feature)
+            and not contains(phonations, feature)) {
+            manners.push_back(feature);
+        }
+    }
+}
+
+std::vector<std::string> FeatureSpace::getCombinations() {
+
+    std::vector<std::string> combinations;
+
+    for (std::string place : places) {
+        for (std::string manner : manners) {
+            for (std::string phonation : phonations) {
+                combinations.push_back(place + ";" + manner + ";" + phonation);
+            }
+        }
+    }
+    return combinations;
+}
+
+/* Render symbol of the glyph and compute its geometry hashes. */
+static void computeGlyph(
+    Glyph& glyph,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    Symbol symbol(getDescriptors(glyph.parameters, graphs));
+    SymbolStyle style((std::vector<std::string>()));
+
+    std::vector<Primitive> visible;
+    for (const Primitive& primitive :
+         symbol.primitives(style, Vector(0, 0), 1.0f)) {
+        if (primitive.settings != "draw=none") {
+            visible.push_back(primitive);
+        }
+    }
+    glyph.hash = getGeometryHash(visible);
+
+    for (unsigned i = 0; i < visible.size(); i++) {
+        std::vector<Primitive> reduced = visible;
+        reduced.erase(reduced.begin() + i);
+        glyph.reducedHashes.push_back(getGeometryHash(reduced));
+    }
+    glyph.primitives = std::move(visible);
+}
+
+std::vector<Glyph> computeGlyphs(
+    std::vector<std::string> combinations,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    IpaSymbols* ipaSymbols,
+    unsigned threadCount) {
+
+    std::vector<Glyph> glyphs(combinations.size());
+
+    for (unsigned i = 0; i < combinations.size(); i++) {
+        glyphs[i].parameters = combinations[i];
+        glyphs[i].ipaSymbol
+            = ipaSymbols->findSymbol(sortParameters(combinations[i]));
+    }
+
+    // Threads take the next glyph until all glyphs are computed.
+    std::atomic<size_t> next = 0;
+    auto work = [&]() {
+        for (size_t i = next++; i < glyphs.size(); i = next++) {
+            computeGlyph(glyphs[i], graphs);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return glyphs;
+}
+
+std::string getGlyphName(const Glyph& glyph) {
+    bool hasIpaSymbol = glyph.ipaSymbol != "-" and glyph.ipaSymbol != "="
+        and glyph.ipaSymbol != " ";
+    if (hasIpaSymbol) {
+        return glyph.parameters + " (" + glyph.ipaSymbol + ")";
+    }
+    return glyph.parameters;
+}
+
+/* Text representation of the group of glyphs with the same geometry. */
+static std::string getGroupName(
+    const std::vector<Glyph>& glyphs, std::vector<unsigned> indices) {
+
+    std::string name = getGlyphName(glyphs[indices[0]]);
+    for (unsigned i = 1; i < indices.size(); i++) {
+        name += " = " + getGlyphName(glyphs[indices[i]]);
+    }
+    return name;
+}
+
+unsigned checkGlyphs(const std::vector<Glyph>& glyphs, std::ostream& output) {
+
+    // Group glyphs by geometry, groups are ordered by their first glyph.
+    // Glyphs with the same hash are compared, so that a hash collision is not
+    // reported as a symbol collision.
+    std::unordered_map<size_t, std::vector<unsigned>> hashToGroups;
+    std::vector<std::vector<unsigned>> groups;
+    for (unsigned i = 0; i < glyphs.size(); i++) {
+        std::vector<unsigned>& sameHash = hashToGroups[glyphs[i].hash];
+        auto group = std::find_if(
+            sameHash.begin(), sameHash.end(), [&](unsigned group) {
+                return isSameGeometry(
+                    glyphs[groups[group][0]].primitives, glyphs[i].primitives);
+            });
+        if (group == sameHash.end()) {
+            sameHash.push_back(groups.size());
+            groups.push_back({i});
+        } else {
+            groups[*group].push_back(i);
+        }
+    }
+
+    output << "Combinations: " << glyphs.size()
+           << ", distinct glyphs: " << groups.size() << "." << std::endl;
+
+    unsigned collisions = 0;
+    output << std::endl << "Collisions:" << std::endl;
+    for (std::vector<unsigned> group : groups) {
+        if (group.size() > 1) {
+            output << "    " << getGroupName(glyphs, group) << std::endl;
+            collisions++;
+        }
+    }
+
+    // Geometries differing by one primitive share a reduced hash, or the hash
+    // of one is a reduced hash of another.
+    std::unordered_map<size_t, std::set<unsigned>> reducedToGroups;
+    for (unsigned i = 0; i < groups.size(); i++) {
+        for (size_t reducedHash : glyphs[groups[i][0]].reducedHashes) {
+            reducedToGroups[reducedHash].insert(i);
+        }
+    }
+    std::set<std::pair<unsigned, unsigned>> nearPairs;
+    for (auto& [reducedHash, nearGroups] : reducedToGroups) {
+        auto reduced = hashToGroups.find(reducedHash);
+        for (unsigned group1 : nearGroups) {
+            for (unsigned group2 : nearGroups) {
+                if (group1 < group2) {
+                    nearPairs.insert({group1, group2});
+                }
+            }
+            if (reduced == hashToGroups.end()) {
+                continue;
+            }
+            for (unsigned group2 : reduced->second) {
+                nearPairs.insert(
+                    {std::min(group1, group2), std::max(group1, group2)});
+            }
+        }
+    }
+    output << std::endl << "Near-collisions:" << std::endl;
+    for (auto& [group1, group2] : nearPairs) {
+        output << "    " << getGroupName(glyphs, groups[group1]) << " ~ "
+               << getGroupName(glyphs, groups[group2]) << std::endl;
+    }
+    output << std::endl
+           << "Collisions: " << collisions
+           << ", near-collisions: " << nearPairs.size() << "." << std::endl;
+
+    return collisions;
+}
@@ -0,0 +1,194 @@
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "featural.h"
+#include "filter.hpp"
+#include "query.hpp"
+#include "symbol.hpp"
+#include "util.hpp"
+#include "visual.hpp"
+
+struct FeaturalData {
+    std::unordered_map<std::string, std::vector<std::string>> graphs;
+    std::unique_ptr<IpaSymbols> ipaSymbols;
+    std::unique_ptr<InventoryIndex> inventoryIndex;
+};
+
+static thread_local std::string lastError;
+static thread_local bool profiling = false;
+static thread_local FeaturalProfile profile;
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/*
+ * Copy output into the buffer as much as it fits and return the full size.
+ */
+static long writeOutput(const std::string& output, char* buffer, size_t size) {
+    std::memcpy(buffer, output.data(), std::min(size, output.size()));
+    return static_cast<long>(output.size());
+}
+
+/*
+ * Draw with the function into a TikZ painter and write the output.
+ *
+ * With profiling, primitives are recorded first and then written by the TikZ
+ * painter, so that geometry and formatting are timed separately. The output
+ * is the same.
+ */
+template <typename Draw>
+static long renderTikz(Draw draw, char* buffer, size_t bufferSize) {
+
+    TikzPainter painter("");
+
+    if (not profiling) {
+        draw(painter);
+        painter.end();
+        return writeOutput(painter.getString(), buffer, bufferSize);
+    }
+    Clock::time_point start = Clock::now();
+    RecordingPainter recording;
+    draw(recording);
+    Clock::time_point recorded = Clock::now();
+
+    for (const Primitive& primitive : recording.primitives) {
+        replay(primitive, painter);
+    }
+    painter.end();
+    std::string output = painter.getString();
+    long size = writeOutput(output, buffer, bufferSize);
+
+    profile.geometry += getSeconds(start, recorded);
+    profile.formatting += getSeconds(recorded, Clock::now());
+    profile.calls++;
+    profile.primitives += recording.primitives.size();
+    profile.outputSize += output.size();
+    return size;
+}
+
+FeaturalData* featural_load(const char* graphsPath, const char* tablesPath) {
+    try {
+        Clock::time_point start = Clock::now();
+        // Data is owned here until everything is parsed.
+        auto data = std::make_unique<FeaturalData>();
+        data->graphs = parseGraphs(graphsPath);
+        data->ipaSymbols.reset(parseTables(tablesPath));
+        data->inventoryIndex = std::make_unique<InventoryIndex>(
+            data->graphs, *data->ipaSymbols);
+        if (profiling) {
+            profile.parsing += getSeconds(start, Clock::now());
+        }
+        return data.release();
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+void featural_free(FeaturalData* data) {
+    delete data;
+}
+
+long featural_render_symbol(
+    const char* const* parameters,
+    size_t parameterCount,
+    char* buffer,
+    size_t bufferSize) {
+
+    try {
+        Clock::time_point start = Clock::now();
+        std::vector<std::string> parametersVector(
+            parameters, parameters + parameterCount);
+        std::pair<Symbol, SymbolStyle> pair
+            = parseSymbolParameters(parametersVector);
+        if (profiling) {
+            profile.parsing += getSeconds(start, Clock::now());
+        }
+        return renderTikz(
+            [&](auto& painter) {
+                pair.first.draw(painter, pair.second, Vector(0, 0), 0.1f);
+            },
+            buffer,
+            bufferSize);
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return -1;
+    }
+}
+
+long featural_render_table(
+    FeaturalData* data,
+    const char* rows,
+    const char* columns,
+    const char* filter,
+    char* buffer,
+    size_t bufferSize) {
+
+    try {
+        Clock::time_point start = Clock::now();
+        std::vector<std::string> rowsVector = split(rows, ',');
+        std::vector<std::string> columnsVector = split(columns, ',');
+        TableCells cells(
+            rowsVector,
+            columnsVector,
+            split(filter, ','),
+            data->ipaSymbols.get(),
+            data->graphs);
+        if (profiling) {
+            profile.parsing += getSeconds(start, Clock::now());
+        }
+        return renderTikz(
+            [&](auto& painter) {
+                drawTable(painter, rowsVector, columnsVector, cells);
+            },
+            buffer,
+            bufferSize);
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return -1;
+    }
+}
+
+long featural_query(
+    FeaturalData* data,
+    const char* expression,
+    char* buffer,
+    size_t bufferSize) {
+
+    try {
+        const InventoryIndex& index = *data->inventoryIndex;
+        Bitset cells = index.query(QueryExpression(expression));
+        std::string output;
+        for (size_t cell : cells.getIndices()) {
+            output += index.getIpaSymbol(cell) + " " + index.getCell(cell)
+                + "\n";
+        }
+        return writeOutput(output, buffer, bufferSize);
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return -1;
+    }
+}
+
+void featural_set_profiling(int enabled) {
+    profiling = enabled;
+}
+
+void featural_get_profile(FeaturalProfile* result) {
+    *result = profile;
+}
+
+void featural_reset_profile(void) {
+    profile = FeaturalProfile();
+}
+
+const char* featural_error(void) {
+    return lastError.c_str();
+}
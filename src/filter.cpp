@@ -0,0 +1,141 @@
+#include <fstream>
+#include <stdexcept>
+
+#include "filter.hpp"
+
+bool TableFilter::Threshold::passes(float value) const {
+    if (isGreater) {
+        return isStrict ? value > frequency : value >= frequency;
+    }
+    return isStrict ? value < frequency : value <= frequency;
+}
+
+TableFilter::TableFilter(
+    const std::vector<std::string>& items, const std::string& frequencyPath) {
+
+    for (const std::string& item : items) {
+        if (item.size() > 1 and item[0] == '@') {
+            expressions.emplace_back(item.substr(1));
+        } else if (item.size() > 1 and (item[0] == '>' or item[0] == '<')) {
+            Threshold threshold;
+            threshold.isGreater = item[0] == '>';
+            threshold.isStrict = item[1] != '=';
+
+            std::string value = item.substr(threshold.isStrict ? 1 : 2);
+            bool isPercent = not value.empty() and value.back() == '%';
+            if (isPercent) {
+                value.pop_back();
+            }
+            size_t end = 0;
+            try {
+                threshold.frequency = std::stof(value, &end);
+            } catch (const std::exception&) { }
+            if (value.empty() or end != value.size()) {
+                throw std::invalid_argument(
+                    "Unknown frequency threshold `" + item + "`.");
+            }
+            if (isPercent) {
+                threshold.frequency /= 100;
+            }
+            thresholds.push_back(threshold);
+        } else {
+            symbols.insert(item);
+        }
+    }
+    if (thresholds.empty()) {
+        return;
+    }
+
+    // Every line is a phoneme, its frequency as a phoneme, and its frequency
+    // as an allophone.
+    std::ifstream file(frequencyPath);
+    if (not file.is_open()) {
+        throw std::invalid_argument(
+            "Could not open the file " + frequencyPath + ".");
+    }
+    std::string phoneme;
+    float phonemeFrequency;
+    float allophoneFrequency;
+    while (file >> phoneme >> phonemeFrequency >> allophoneFrequency) {
+        frequencies[phoneme] = phonemeFrequency;
+    }
+}
+
+Bitset TableFilter::compile(
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const std::vector<std::string>& cellSymbols,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs)
+    const {
+
+    size_t size = cellSymbols.size();
+    Bitset result(size);
+
+    // Expressions and thresholds match only cells with IPA symbols.
+    Bitset symbolCells(size);
+    for (size_t i = 0; i < size; i++) {
+        if (symbols.contains(cellSymbols[i])) {
+            result.set(i);
+        }
+        if (hasIpaSymbol(cellSymbols[i])) {
+            symbolCells.set(i);
+        }
+    }
+
+    if (not expressions.empty()) {
+        for (const QueryExpression& expression : expressions) {
+            for (const std::string& term : expression.getTerms()) {
+                if (not isKnownTerm(term, graphs)) {
+                    throw std::invalid_argument(
+                        "Unknown query term `" + term + "`.");
+                }
+            }
+        }
+        // Terms absent in the table match no cells.
+        std::unordered_map<std::string, Bitset> postings;
+        for (size_t i = 0; i < size; i++) {
+            if (not symbolCells.test(i)) {
+                continue;
+            }
+            std::string parameters = columns[i % columns.size()] + ";"
+                + rows[i / columns.size()];
+            for (const std::string& term : getCellTerms(parameters, graphs)) {
+                postings.try_emplace(term, size).first->second.set(i);
+            }
+        }
+        auto getTerm = [&](const std::string& term) {
+            auto it = postings.find(term);
+            return it == postings.end() ? Bitset(size) : it->second;
+        };
+        for (const QueryExpression& expression : expressions) {
+            Bitset cells = expression.evaluate(getTerm, size);
+            cells &= symbolCells;
+            result |= cells;
+        }
+    }
+
+    if (not thresholds.empty()) {
+        bool hasOnlyThresholds = symbols.empty() and expressions.empty();
+        Bitset passing(size);
+
+        for (size_t i = 0; i < size; i++) {
+            if (not symbolCells.test(i)) {
+                continue;
+            }
+            auto it = frequencies.find(cellSymbols[i]);
+            float frequency = it == frequencies.end() ? 0.0f : it->second;
+            bool passes = true;
+            for (const Threshold& threshold : thresholds) {
+                passes = passes and threshold.passes(frequency);
+            }
+            if (passes) {
+                passing.set(i);
+                if (hasOnlyThresholds) {
+                    result.set(i);
+                }
+            }
+        }
+        result &= passing;
+    }
+    return result;
+}
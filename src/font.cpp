@@ -0,0 +1,614 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <numbers>
+#include <stdexcept>
+
+#include "font.hpp"
+
+/* Size of table symbols, the style line width is relative to it. */
+static const float FONT_SYMBOL_SIZE = 0.1f;
+
+/* Number of segments a cubic Bezier curve is flattened into. */
+static const unsigned CURVE_STEPS = 16;
+
+static const int FONT_ASCENDER = 800;
+static const int FONT_DESCENDER = -200;
+
+// Outlines.
+
+static Vector normalize(Vector vector) {
+    float length = std::hypot(vector.x, vector.y);
+    if (length == 0) {
+        return Vector();
+    }
+    return vector * (1 / length);
+}
+
+/* Left normal: the direction rotated by 90° counterclockwise. */
+static Vector getNormal(Vector direction) {
+    return Vector(-direction.y, direction.x);
+}
+
+/* Points of the stroke center line, collinear points are removed. */
+static std::vector<Vector> flatten(const Primitive& primitive) {
+
+    const Vector* points = primitive.points;
+    std::vector<Vector> samples;
+
+    if (primitive.type == PrimitiveType::Curve) {
+        for (unsigned i = 0; i <= CURVE_STEPS; i++) {
+            float t = static_cast<float>(i) / CURVE_STEPS;
+            float s = 1 - t;
+            samples.push_back(
+                points[0] * (s * s * s) + points[1] * (3 * s * s * t)
+                + points[2] * (3 * s * t * t) + points[3] * (t * t * t));
+        }
+    } else {
+        samples = {points[0], points[1]};
+    }
+
+    // Straight lines are often drawn as curves with control points at the
+    // ends, keep only their end points.
+    std::vector<Vector> result = {samples[0]};
+    for (unsigned i = 1; i + 1 < samples.size(); i++) {
+        Vector incoming = normalize(samples[i] - result.back());
+        Vector outgoing = normalize(samples[i + 1] - samples[i]);
+        float cross = incoming.x * outgoing.y - incoming.y * outgoing.x;
+        float dot = incoming.x * outgoing.x + incoming.y * outgoing.y;
+        if (incoming == Vector() or std::fabs(cross) > 1e-4f or dot < 0) {
+            if (not(samples[i] == result.back())) {
+                result.push_back(samples[i]);
+            }
+        }
+    }
+    if (not(samples.back() == result.back())) {
+        result.push_back(samples.back());
+    }
+    return result;
+}
+
+/*
+ * Add clockwise arc around the center from the direction by 180°, without
+ * its first point.
+ */
+static void
+addCap(Contour& contour, Vector center, Vector direction, float radius) {
+
+    // Quadratic arc of 45° has its control point at the tangent intersection.
+    float step = std::numbers::pi_v<float> / 4;
+    float controlRadius = radius / std::cos(step / 2);
+    float start = std::atan2(direction.y, direction.x);
+
+    for (unsigned i = 0; i < 4; i++) {
+        float control = start - (i + 0.5f) * step;
+        float end = start - (i + 1) * step;
+        contour.push_back(
+            {center
+                 + Vector(std::cos(control), std::sin(control))
+                     * controlRadius,
+             false});
+        contour.push_back(
+            {center + Vector(std::cos(end), std::sin(end)) * radius, true});
+    }
+}
+
+Contour outlineStroke(const Primitive& primitive, float halfWidth) {
+
+    std::vector<Vector> points = flatten(primitive);
+    Contour contour;
+
+    if (points.size() == 1) {
+        // Zero-length stroke is a dot.
+        contour.push_back({points[0] + Vector(0, halfWidth), true});
+        addCap(contour, points[0], Vector(0, 1), halfWidth);
+        addCap(contour, points[0], Vector(0, -1), halfWidth);
+        contour.pop_back();
+        return contour;
+    }
+
+    // Normals at points bisect adjacent segments, so that offset curves stay
+    // parallel to the center line.
+    std::vector<Vector> normals;
+    for (unsigned i = 0; i < points.size(); i++) {
+        Vector previous = points[i == 0 ? 0 : i - 1];
+        Vector next = points[i + 1 == points.size() ? i : i + 1];
+        normals.push_back(getNormal(normalize(next - previous)));
+    }
+
+    // Left side forward, end cap, right side backward, start cap.
+    for (unsigned i = 0; i < points.size(); i++) {
+        contour.push_back({points[i] + normals[i] * halfWidth, true});
+    }
+    addCap(contour, points.back(), normals.back(), halfWidth);
+    for (unsigned i = points.size() - 1; i-- > 0;) {
+        contour.push_back({points[i] - normals[i] * halfWidth, true});
+    }
+    addCap(contour, points[0], normals[0] * -1, halfWidth);
+
+    // The cap ends at the first point.
+    contour.pop_back();
+    return contour;
+}
+
+FontGlyph
+createFontGlyph(const Symbol& symbol, SymbolStyle style, uint32_t codePoint) {
+
+    float halfWidth = style.lineWidth / 2 / POINTS_PER_CM / FONT_SYMBOL_SIZE;
+
+    FontGlyph glyph;
+    glyph.codePoint = codePoint;
+    for (const Primitive& primitive :
+         symbol.primitives(style, Vector(0, 0), 1.0f)) {
+        if (primitive.settings != "draw=none"
+            and (primitive.type == PrimitiveType::Line
+                 or primitive.type == PrimitiveType::Curve)) {
+            glyph.contours.push_back(outlineStroke(primitive, halfWidth));
+        }
+    }
+
+    BoundingBox box;
+    for (const Contour& contour : glyph.contours) {
+        for (const ContourPoint& point : contour) {
+            box.add(point.point);
+        }
+    }
+    // Symbol center is one symbol unit above the baseline, the ink starts at
+    // the left side bearing of half of the line width.
+    Vector shift
+        = box.isEmpty ? Vector() : Vector(halfWidth - box.minimum.x, 1);
+    for (Contour& contour : glyph.contours) {
+        for (ContourPoint& point : contour) {
+            point.point = (point.point + shift) * FONT_UNITS_PER_SYMBOL;
+        }
+    }
+    float width = box.isEmpty ? 0 : box.getWidth();
+    glyph.advance
+        = std::lround((width + 2 * halfWidth) * FONT_UNITS_PER_SYMBOL);
+    return glyph;
+}
+
+// TrueType tables.
+
+/* Big-endian binary data of a font table. */
+class FontData {
+
+public:
+    std::string data;
+
+    void u8(uint8_t value) {
+        data.push_back(static_cast<char>(value));
+    }
+    void u16(uint16_t value) {
+        u8(value >> 8);
+        u8(value & 0xFF);
+    }
+    void i16(int16_t value) {
+        u16(static_cast<uint16_t>(value));
+    }
+    void u32(uint32_t value) {
+        u16(value >> 16);
+        u16(value & 0xFFFF);
+    }
+    void tag(const char* value) {
+        data.append(value, 4);
+    }
+    void pad() {
+        while (data.size() % 4 != 0) {
+            u8(0);
+        }
+    }
+    void setU32(size_t offset, uint32_t value) {
+        for (unsigned i = 0; i < 4; i++) {
+            data[offset + i] = static_cast<char>(value >> (24 - 8 * i));
+        }
+    }
+};
+
+/* Sum of the data as big-endian 32-bit numbers, padded with zeros. */
+static uint32_t getChecksum(const std::string& data) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < data.size(); i += 4) {
+        uint32_t word = 0;
+        for (size_t j = 0; j < 4; j++) {
+            uint8_t byte = i + j < data.size() ? data[i + j] : 0;
+            word = (word << 8) | byte;
+        }
+        sum += word;
+    }
+    return sum;
+}
+
+/* Glyph with coordinates rounded to font units. */
+class RoundedGlyph {
+
+public:
+    std::vector<std::vector<std::pair<int16_t, int16_t>>> contours;
+    std::vector<std::vector<bool>> onCurve;
+    int16_t xMin = 0;
+    int16_t yMin = 0;
+    int16_t xMax = 0;
+    int16_t yMax = 0;
+    uint16_t advance = 0;
+    unsigned pointCount = 0;
+};
+
+static RoundedGlyph roundGlyph(const FontGlyph& glyph) {
+
+    RoundedGlyph rounded;
+    rounded.advance = glyph.advance;
+    bool isEmpty = true;
+
+    for (const Contour& contour : glyph.contours) {
+        rounded.contours.push_back({});
+        rounded.onCurve.push_back({});
+        for (const ContourPoint& point : contour) {
+            int16_t x = std::lround(point.point.x);
+            int16_t y = std::lround(point.point.y);
+            rounded.contours.back().push_back({x, y});
+            rounded.onCurve.back().push_back(point.isOnCurve);
+            rounded.pointCount++;
+
+            if (isEmpty) {
+                rounded.xMin = rounded.xMax = x;
+                rounded.yMin = rounded.yMax = y;
+                isEmpty = false;
+            }
+            rounded.xMin = std::min(rounded.xMin, x);
+            rounded.yMin = std::min(rounded.yMin, y);
+            rounded.xMax = std::max(rounded.xMax, x);
+            rounded.yMax = std::max(rounded.yMax, y);
+        }
+    }
+    return rounded;
+}
+
+/* Simple glyph description, empty for glyphs without contours. */
+static std::string writeGlyph(const RoundedGlyph& glyph) {
+
+    FontData table;
+    if (glyph.contours.empty()) {
+        return table.data;
+    }
+    table.i16(glyph.contours.size());
+    table.i16(glyph.xMin);
+    table.i16(glyph.yMin);
+    table.i16(glyph.xMax);
+    table.i16(glyph.yMax);
+
+    unsigned end = 0;
+    for (const auto& contour : glyph.contours) {
+        end += contour.size();
+        table.u16(end - 1);
+    }
+    table.u16(0); // No instructions.
+
+    // Flags without repeats, coordinates as 16-bit deltas.
+    for (const std::vector<bool>& onCurve : glyph.onCurve) {
+        for (bool isOnCurve : onCurve) {
+            table.u8(isOnCurve ? 0x01 : 0x00);
+        }
+    }
+    for (unsigned axis = 0; axis < 2; axis++) {
+        int16_t previous = 0;
+        for (const auto& contour : glyph.contours) {
+            for (auto [x, y] : contour) {
+                int16_t value = axis == 0 ? x : y;
+                table.i16(value - previous);
+                previous = value;
+            }
+        }
+    }
+    table.pad();
+    return table.data;
+}
+
+/* Format 4 subtable mapping the code points to glyph indices. */
+static std::string writeCharacterMap(const std::vector<uint32_t>& codePoints) {
+
+    // Segments of consecutive code points with consecutive glyph indices:
+    // start code, end code, and the first glyph index.
+    std::vector<std::array<uint32_t, 3>> segments;
+    for (uint32_t i = 0; i < codePoints.size(); i++) {
+        if (codePoints[i] >= 0xFFFF) {
+            throw std::invalid_argument("Code point is out of the BMP.");
+        }
+        if (not segments.empty() and segments.back()[1] + 1 == codePoints[i]) {
+            segments.back()[1]++;
+        } else {
+            segments.push_back({codePoints[i], codePoints[i], i + 1});
+        }
+    }
+    segments.push_back({0xFFFF, 0xFFFF, 0});
+
+    uint16_t segmentCount = segments.size();
+    uint16_t searchRange = 2;
+    uint16_t entrySelector = 0;
+    while (searchRange * 2 <= segmentCount * 2) {
+        searchRange *= 2;
+        entrySelector++;
+    }
+    FontData subtable;
+    subtable.u16(4);
+    subtable.u16(16 + 8 * segmentCount);
+    subtable.u16(0); // Language.
+    subtable.u16(segmentCount * 2);
+    subtable.u16(searchRange);
+    subtable.u16(entrySelector);
+    subtable.u16(segmentCount * 2 - searchRange);
+    for (auto& segment : segments) {
+        subtable.u16(segment[1]);
+    }
+    subtable.u16(0); // Reserved.
+    for (auto& segment : segments) {
+        subtable.u16(segment[0]);
+    }
+    for (auto& segment : segments) {
+        // Deltas are modulo 2^16, the last segment maps 0xFFFF to glyph 0.
+        subtable.u16(segment[2] == 0 ? 1 : segment[2] - segment[0]);
+    }
+    for (unsigned i = 0; i < segmentCount; i++) {
+        subtable.u16(0); // Range offset.
+    }
+
+    FontData table;
+    table.u16(0);
+    table.u16(2);
+    // Unicode BMP and Windows Unicode BMP share the subtable.
+    table.u16(0);
+    table.u16(3);
+    table.u32(20);
+    table.u16(3);
+    table.u16(1);
+    table.u32(20);
+    table.data += subtable.data;
+    return table.data;
+}
+
+static std::string writeNames(const std::string& familyName) {
+
+    std::vector<std::pair<uint16_t, std::string>> names = {
+        {1, familyName},
+        {2, "Regular"},
+        {3, familyName + " Regular"},
+        {4, familyName + " Regular"},
+        {5, "Version 1.0"},
+        {6, familyName + "-Regular"}};
+
+    FontData table;
+    table.u16(0);
+    table.u16(names.size());
+    table.u16(6 + 12 * names.size());
+
+    // Windows names are UTF-16, names are ASCII.
+    std::string strings;
+    for (auto& [id, name] : names) {
+        table.u16(3);
+        table.u16(1);
+        table.u16(0x0409);
+        table.u16(id);
+        table.u16(2 * name.size());
+        table.u16(strings.size());
+        for (char character : name) {
+            strings.push_back('\0');
+            strings.push_back(character);
+        }
+    }
+    table.data += strings;
+    return table.data;
+}
+
+void writeFont(
+    const std::string& path,
+    const std::string& familyName,
+    const std::vector<FontGlyph>& glyphs) {
+
+    // `.notdef`, space, and the glyphs.
+    std::vector<RoundedGlyph> rounded(2);
+    rounded[0].advance = FONT_UNITS_PER_EM / 2;
+    rounded[1].advance = FONT_UNITS_PER_EM / 4;
+    std::vector<uint32_t> codePoints = {' '};
+    for (const FontGlyph& glyph : glyphs) {
+        if (glyph.codePoint <= codePoints.back()) {
+            throw std::invalid_argument("Code points should be increasing.");
+        }
+        rounded.push_back(roundGlyph(glyph));
+        codePoints.push_back(glyph.codePoint);
+    }
+
+    FontData glyf;
+    FontData loca;
+    FontData hmtx;
+    RoundedGlyph bounds;
+    bool isEmpty = true;
+    uint16_t maxPoints = 0;
+    uint16_t maxContours = 0;
+    uint16_t advanceMax = 0;
+    int16_t minLeftBearing = 0;
+    int16_t minRightBearing = 0;
+    int16_t maxExtent = 0;
+    uint32_t advanceSum = 0;
+
+    for (const RoundedGlyph& glyph : rounded) {
+        loca.u32(glyf.data.size());
+        glyf.data += writeGlyph(glyph);
+        hmtx.u16(glyph.advance);
+        hmtx.i16(glyph.xMin);
+
+        maxPoints = std::max<uint16_t>(maxPoints, glyph.pointCount);
+        maxContours = std::max<uint16_t>(maxContours, glyph.contours.size());
+        advanceMax = std::max(advanceMax, glyph.advance);
+        advanceSum += glyph.advance;
+        if (glyph.contours.empty()) {
+            continue;
+        }
+        int16_t rightBearing = glyph.advance - glyph.xMax;
+        if (isEmpty) {
+            bounds.xMin = glyph.xMin;
+            bounds.yMin = glyph.yMin;
+            bounds.xMax = glyph.xMax;
+            bounds.yMax = glyph.yMax;
+            minLeftBearing = glyph.xMin;
+            minRightBearing = rightBearing;
+            isEmpty = false;
+        }
+        bounds.xMin = std::min(bounds.xMin, glyph.xMin);
+        bounds.yMin = std::min(bounds.yMin, glyph.yMin);
+        bounds.xMax = std::max(bounds.xMax, glyph.xMax);
+        bounds.yMax = std::max(bounds.yMax, glyph.yMax);
+        minLeftBearing = std::min(minLeftBearing, glyph.xMin);
+        minRightBearing = std::min(minRightBearing, rightBearing);
+        maxExtent = std::max(maxExtent, glyph.xMax);
+    }
+    loca.u32(glyf.data.size());
+    uint16_t glyphCount = rounded.size();
+
+    FontData head;
+    head.u32(0x00010000);
+    head.u32(0x00010000); // Font revision.
+    head.u32(0); // Checksum adjustment, set below.
+    head.u32(0x5F0F3CF5);
+    head.u16(0x0009); // Baseline at 0, integer scaling.
+    head.u16(FONT_UNITS_PER_EM);
+    // Created and modified: fixed date, 2024-01-01, so that the output is
+    // reproducible.
+    for (unsigned i = 0; i < 2; i++) {
+        head.u32(0);
+        head.u32(3786912000u);
+    }
+    head.i16(bounds.xMin);
+    head.i16(bounds.yMin);
+    head.i16(bounds.xMax);
+    head.i16(bounds.yMax);
+    head.u16(0); // Style.
+    head.u16(8); // Smallest readable size in pixels.
+    head.i16(2); // Direction hint.
+    head.i16(1); // 32-bit `loca` offsets.
+    head.i16(0);
+
+    FontData hhea;
+    hhea.u32(0x00010000);
+    hhea.i16(FONT_ASCENDER);
+    hhea.i16(FONT_DESCENDER);
+    hhea.i16(0); // Line gap.
+    hhea.u16(advanceMax);
+    hhea.i16(minLeftBearing);
+    hhea.i16(minRightBearing);
+    hhea.i16(maxExtent);
+    hhea.i16(1); // Vertical caret.
+    hhea.i16(0);
+    hhea.i16(0);
+    for (unsigned i = 0; i < 5; i++) {
+        hhea.i16(0); // Reserved and metric data format.
+    }
+    hhea.u16(glyphCount);
+
+    FontData maxp;
+    maxp.u32(0x00010000);
+    maxp.u16(glyphCount);
+    maxp.u16(maxPoints);
+    maxp.u16(maxContours);
+    maxp.u16(0); // Composite points and contours.
+    maxp.u16(0);
+    maxp.u16(2); // Zones.
+    for (unsigned i = 0; i < 8; i++) {
+        maxp.u16(0); // No instructions and components.
+    }
+
+    FontData os2;
+    os2.u16(4);
+    os2.i16(advanceSum / glyphCount);
+    os2.u16(400); // Regular weight.
+    os2.u16(5); // Medium width.
+    os2.u16(0); // Installable embedding.
+    for (int16_t value : {650, 600, 0, 75, 650, 600, 0, 350, 50, 250}) {
+        os2.i16(value); // Subscript, superscript, and strikeout.
+    }
+    os2.i16(0); // Family class.
+    for (unsigned i = 0; i < 10; i++) {
+        os2.u8(0); // PANOSE.
+    }
+    os2.u32(1); // Basic Latin for the space.
+    os2.u32(1 << 28); // Private use area.
+    os2.u32(0);
+    os2.u32(0);
+    os2.tag("NONE");
+    os2.u16(0x0040); // Regular.
+    os2.u16(codePoints.front());
+    os2.u16(codePoints.back());
+    os2.i16(FONT_ASCENDER);
+    os2.i16(FONT_DESCENDER);
+    os2.i16(0);
+    os2.u16(std::max<int>(FONT_ASCENDER, bounds.yMax));
+    os2.u16(std::max<int>(-FONT_DESCENDER, -bounds.yMin));
+    os2.u32(1); // Latin 1 code page.
+    os2.u32(0);
+    os2.i16(2 * FONT_UNITS_PER_SYMBOL); // x-height and cap height.
+    os2.i16(2 * FONT_UNITS_PER_SYMBOL);
+    os2.u16(0); // Default character.
+    os2.u16(' '); // Break character.
+    os2.u16(1); // Context.
+
+    FontData post;
+    post.u32(0x00030000); // No glyph names.
+    post.u32(0); // Italic angle.
+    post.i16(-100); // Underline position and thickness.
+    post.i16(50);
+    for (unsigned i = 0; i < 5; i++) {
+        post.u32(0);
+    }
+
+    // Tables are sorted by tag.
+    std::map<std::string, std::string> tables = {
+        {"OS/2", os2.data},
+        {"cmap", writeCharacterMap(codePoints)},
+        {"glyf", glyf.data},
+        {"head", head.data},
+        {"hhea", hhea.data},
+        {"hmtx", hmtx.data},
+        {"loca", loca.data},
+        {"maxp", maxp.data},
+        {"name", writeNames(familyName)},
+        {"post", post.data}};
+
+    uint16_t tableCount = tables.size();
+    uint16_t searchRange = 1;
+    uint16_t entrySelector = 0;
+    while (searchRange * 2 <= tableCount) {
+        searchRange *= 2;
+        entrySelector++;
+    }
+    FontData font;
+    font.u32(0x00010000);
+    font.u16(tableCount);
+    font.u16(searchRange * 16);
+    font.u16(entrySelector);
+    font.u16(tableCount * 16 - searchRange * 16);
+
+    size_t offset = font.data.size() + 16 * tableCount;
+    size_t headOffset = 0;
+    for (auto& [tag, table] : tables) {
+        font.tag(tag.c_str());
+        font.u32(getChecksum(table));
+        font.u32(offset);
+        font.u32(table.size());
+        if (tag == "head") {
+            headOffset = offset;
+        }
+        offset += (table.size() + 3) / 4 * 4;
+    }
+    for (auto& [tag, table] : tables) {
+        font.data += table;
+        font.pad();
+    }
+    font.setU32(headOffset + 8, 0xB1B0AFBA - getChecksum(font.data));
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(font.data.data(), font.data.size());
+    file.close();
+    if (file.fail()) {
+        throw std::invalid_argument("Could not write the file " + path);
+    }
+}
@@ -1,4 +1,9 @@
+#include <algorithm>
 #include <cmath>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "geometry.hpp"
 
@@ -18,31 +23,283 @@ Vector::Vector(float x, float y) {
     this->y = y;
 }
 
-Vector Vector::operator*(float p) {
+Vector Vector::operator*(float p) const {
     return Vector(x * p, y * p);
 }
 
-Vector Vector::operator+(Vector other) {
+Vector Vector::operator+(Vector other) const {
     return Vector(x + other.x, y + other.y);
 }
 
-Vector Vector::operator-(Vector other) {
+Vector Vector::operator-(Vector other) const {
     return Vector(x - other.x, y - other.y);
 }
 
-bool Vector::operator==(Vector other) {
+bool Vector::operator==(Vector other) const {
     return x == other.x and y == other.y;
 }
 
-bool Vector::isGridParallelTo(Vector other) {
+Transform::Transform() { }
+
+Transform::Transform(float a, float b, float c, float d, float e, float f)
+    : a(a), b(b), c(c), d(d), e(e), f(f) { }
+
+Transform Transform::translation(Vector shift) {
+    return Transform(1.0f, 0.0f, 0.0f, 1.0f, shift.x, shift.y);
+}
+
+Transform Transform::scale(float factor) {
+    return Transform(factor, 0.0f, 0.0f, factor, 0.0f, 0.0f);
+}
+
+Transform Transform::skew(float slant) {
+    return Transform(1.0f, 0.0f, slant, 1.0f, 0.0f, 0.0f);
+}
+
+Transform Transform::operator*(Transform other) const {
+    return Transform(
+        a * other.a + c * other.b,
+        b * other.a + d * other.b,
+        a * other.c + c * other.d,
+        b * other.c + d * other.d,
+        a * other.e + c * other.f + e,
+        b * other.e + d * other.f + f);
+}
+
+Vector Transform::apply(Vector point) const {
+    return Vector(
+        a * point.x + c * point.y + e, b * point.x + d * point.y + f);
+}
+
+void Transform::apply(Vector* points, size_t count) const {
+
+    static_assert(sizeof(Vector) == 2 * sizeof(float));
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // Two points per register: `(x1, y1, x2, y2)`.
+    float* values = reinterpret_cast<float*>(points);
+    __m128 diagonal = _mm_setr_ps(a, d, a, d);
+    __m128 antidiagonal = _mm_setr_ps(c, b, c, b);
+    __m128 shift = _mm_setr_ps(e, f, e, f);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128 point = _mm_loadu_ps(values + 2 * i);
+        __m128 swapped = _mm_shuffle_ps(point, point, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 result = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(diagonal, point), _mm_mul_ps(antidiagonal, swapped)),
+            shift);
+        _mm_storeu_ps(values + 2 * i, result);
+    }
+#endif
+
+    for (; i < count; i++) {
+        points[i] = apply(points[i]);
+    }
+}
+
+void BoundingBox::add(Vector point) {
+    if (isEmpty) {
+        minimum = point;
+        maximum = point;
+        isEmpty = false;
+        return;
+    }
+    minimum.x = std::min(minimum.x, point.x);
+    minimum.y = std::min(minimum.y, point.y);
+    maximum.x = std::max(maximum.x, point.x);
+    maximum.y = std::max(maximum.y, point.y);
+}
+
+/*
+ * Parameters in (0, 1) where the derivative of the cubic Bezier coordinate
+ * is zero.
+ */
+static std::vector<float> getExtremumParameters(
+    float value1, float value2, float value3, float value4) {
+
+    // Derivative divided by 3 is `a t^2 + b t + c`.
+    float a = -value1 + 3 * value2 - 3 * value3 + value4;
+    float b = 2 * (value1 - 2 * value2 + value3);
+    float c = value2 - value1;
+
+    std::vector<float> roots;
+    if (std::fabs(a) < PRECISION) {
+        if (std::fabs(b) >= PRECISION) {
+            roots.push_back(-c / b);
+        }
+    } else {
+        float discriminant = b * b - 4 * a * c;
+        if (discriminant >= 0) {
+            float root = std::sqrt(discriminant);
+            roots.push_back((-b + root) / (2 * a));
+            roots.push_back((-b - root) / (2 * a));
+        }
+    }
+    std::vector<float> parameters;
+    for (float t : roots) {
+        if (t > 0 and t < 1) {
+            parameters.push_back(t);
+        }
+    }
+    return parameters;
+}
+
+void BoundingBox::addCurve(
+    Vector point1, Vector point2, Vector point3, Vector point4) {
+
+    add(point1);
+    add(point4);
+
+    auto getPoint = [&](float t) {
+        float s = 1 - t;
+        return point1 * (s * s * s) + point2 * (3 * s * s * t)
+            + point3 * (3 * s * t * t) + point4 * (t * t * t);
+    };
+    for (float t :
+         getExtremumParameters(point1.x, point2.x, point3.x, point4.x)) {
+        add(getPoint(t));
+    }
+    for (float t :
+         getExtremumParameters(point1.y, point2.y, point3.y, point4.y)) {
+        add(getPoint(t));
+    }
+}
+
+void BoundingBox::pad(float distance) {
+    if (not isEmpty) {
+        minimum = minimum - Vector(distance, distance);
+        maximum = maximum + Vector(distance, distance);
+    }
+}
+
+float BoundingBox::getWidth() const {
+    return isEmpty ? 0.0f : maximum.x - minimum.x;
+}
+
+float BoundingBox::getHeight() const {
+    return isEmpty ? 0.0f : maximum.y - minimum.y;
+}
+
+static float dot(Vector first, Vector second) {
+    return first.x * second.x + first.y * second.y;
+}
+
+float getDistanceToSegment(Vector point, Vector start, Vector end) {
+
+    Vector direction = end - start;
+    float lengthSquared = dot(direction, direction);
+    float t = 0.0f;
+    if (lengthSquared > 0.0f) {
+        t = dot(point - start, direction) / lengthSquared;
+        t = std::clamp(t, 0.0f, 1.0f);
+    }
+    Vector difference = point - (start + direction * t);
+    return std::sqrt(dot(difference, difference));
+}
+
+/* Number of samples to find the closest parameter of a curve. */
+static const int CURVE_SAMPLES = 16;
+
+/* Number of Newton's method iterations to refine the closest parameter. */
+static const int CURVE_ITERATIONS = 4;
+
+float getDistanceToCurve(
+    Vector point, Vector point1, Vector point2, Vector point3, Vector point4) {
+
+    auto getPoint = [&](float t) {
+        float s = 1 - t;
+        return point1 * (s * s * s) + point2 * (3 * s * s * t)
+            + point3 * (3 * s * t * t) + point4 * (t * t * t);
+    };
+    auto getDistanceSquared = [&](float t) {
+        Vector difference = getPoint(t) - point;
+        return dot(difference, difference);
+    };
+
+    float closest = 0.0f;
+    float closestDistance = getDistanceSquared(0.0f);
+    for (int i = 1; i <= CURVE_SAMPLES; i++) {
+        float t = static_cast<float>(i) / CURVE_SAMPLES;
+        float distance = getDistanceSquared(t);
+        if (distance < closestDistance) {
+            closest = t;
+            closestDistance = distance;
+        }
+    }
+
+    // Find the root of `(B(t) - point) · B'(t)`, the derivative of the
+    // squared distance divided by 2.
+    float t = closest;
+    for (int i = 0; i < CURVE_ITERATIONS; i++) {
+        float s = 1 - t;
+        Vector difference = getPoint(t) - point;
+        Vector first = (point2 - point1) * (3 * s * s)
+            + (point3 - point2) * (6 * s * t) + (point4 - point3) * (3 * t * t);
+        Vector second = (point3 - point2 * 2 + point1) * (6 * s)
+            + (point4 - point3 * 2 + point2) * (6 * t);
+        float derivative = dot(first, first) + dot(difference, second);
+        if (derivative <= 0.0f) {
+            break;
+        }
+        t = t - dot(difference, first) / derivative;
+        t = std::clamp(t, 0.0f, 1.0f);
+    }
+    return std::sqrt(std::min(closestDistance, getDistanceSquared(t)));
+}
+
+GridVector::GridVector() {
+    this->x = 0;
+    this->y = 0;
+}
+
+GridVector::GridVector(int x, int y) {
+    this->x = x;
+    this->y = y;
+}
+
+GridVector GridVector::operator*(int p) const {
+    return GridVector(
+        static_cast<long long>(x) * p / GRID_SCALE,
+        static_cast<long long>(y) * p / GRID_SCALE);
+}
+
+GridVector GridVector::operator+(GridVector other) const {
+    return GridVector(x + other.x, y + other.y);
+}
+
+GridVector GridVector::operator-(GridVector other) const {
+    return GridVector(x - other.x, y - other.y);
+}
+
+bool GridVector::operator==(GridVector other) const {
+    return x == other.x and y == other.y;
+}
+
+bool GridVector::isGridParallelTo(GridVector other) const {
     return (x == 0 and other.x == 0) or (y == 0 and other.y == 0);
 }
 
-bool Vector::isGridCodirectedTo(Vector other) {
-    return (x == 0 and other.x == 0 and y * other.y >= 0)
-        or (y == 0 and other.y == 0 and x * other.x >= 0);
+bool GridVector::isGridCodirectedTo(GridVector other) const {
+    long long xProduct = static_cast<long long>(x) * other.x;
+    long long yProduct = static_cast<long long>(y) * other.y;
+    return (x == 0 and other.x == 0 and yProduct >= 0)
+        or (y == 0 and other.y == 0 and xProduct >= 0);
+}
+
+bool GridVector::isOrthogonalTo(GridVector other) const {
+    return static_cast<long long>(x) * other.x
+        + static_cast<long long>(y) * other.y
+        == 0;
+}
+
+Vector GridVector::toVector() const {
+    return Vector(
+        static_cast<float>(x) / GRID_SCALE, static_cast<float>(y) / GRID_SCALE);
 }
 
-bool Vector::isOrthogonalTo(Vector other) {
-    return equals(x * other.x + y * other.y, 0);
+GridVector GridVector::fromVector(Vector vector) {
+    return GridVector(
+        std::lround(vector.x * GRID_SCALE), std::lround(vector.y * GRID_SCALE));
 }
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "filter.hpp"
+#include "hit.hpp"
+#include "util.hpp"
+
+// Hit grid.
+
+HitGrid::HitGrid(float cellSize) : cellSize(cellSize) { }
+
+template <typename Function>
+void HitGrid::forEachCell(const BoundingBox& box, Function function) const {
+
+    int minimumX = std::floor(box.minimum.x / cellSize);
+    int minimumY = std::floor(box.minimum.y / cellSize);
+    int maximumX = std::floor(box.maximum.x / cellSize);
+    int maximumY = std::floor(box.maximum.y / cellSize);
+
+    for (int x = minimumX; x <= maximumX; x++) {
+        for (int y = minimumY; y <= maximumY; y++) {
+            function(
+                (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32)
+                | static_cast<uint32_t>(y));
+        }
+    }
+}
+
+unsigned HitGrid::add(const Primitive& primitive, unsigned owner) {
+
+    Item item;
+    item.type = primitive.type;
+    item.owner = owner;
+    std::copy(
+        primitive.points, primitive.points + primitive.pointCount, item.points);
+
+    if (primitive.type == PrimitiveType::Line) {
+        item.box.add(primitive.points[0]);
+        item.box.add(primitive.points[1]);
+    } else if (primitive.type == PrimitiveType::Curve) {
+        item.box.addCurve(
+            primitive.points[0],
+            primitive.points[1],
+            primitive.points[2],
+            primitive.points[3]);
+    } else {
+        throw std::invalid_argument("Only lines and curves can be hit.");
+    }
+
+    unsigned index = items.size();
+    if (freeItems.empty()) {
+        items.push_back(item);
+    } else {
+        index = freeItems.back();
+        freeItems.pop_back();
+        items[index] = item;
+    }
+    forEachCell(item.box, [&](uint64_t key) { cells[key].push_back(index); });
+    return index;
+}
+
+void HitGrid::remove(unsigned item) {
+
+    if (items[item].isRemoved) {
+        return;
+    }
+    forEachCell(items[item].box, [&](uint64_t key) {
+        std::erase(cells[key], item);
+    });
+    items[item].isRemoved = true;
+    freeItems.push_back(item);
+}
+
+std::optional<GridHit>
+HitGrid::findClosest(Vector point, float maximumDistance) const {
+
+    BoundingBox area;
+    area.add(point);
+    area.pad(maximumDistance);
+
+    std::optional<GridHit> result;
+    float closest = maximumDistance;
+
+    forEachCell(area, [&](uint64_t key) {
+        auto cell = cells.find(key);
+        if (cell == cells.end()) {
+            return;
+        }
+        for (unsigned index : cell->second) {
+            const Item& item = items[index];
+
+            // Skip items whose boxes are farther than the closest item.
+            float dx = std::max(
+                {item.box.minimum.x - point.x,
+                 0.0f,
+                 point.x - item.box.maximum.x});
+            float dy = std::max(
+                {item.box.minimum.y - point.y,
+                 0.0f,
+                 point.y - item.box.maximum.y});
+            if (std::sqrt(dx * dx + dy * dy) > closest) {
+                continue;
+            }
+            float distance = item.type == PrimitiveType::Line
+                ? getDistanceToSegment(point, item.points[0], item.points[1])
+                : getDistanceToCurve(
+                      point,
+                      item.points[0],
+                      item.points[1],
+                      item.points[2],
+                      item.points[3]);
+            if (distance <= closest) {
+                closest = distance;
+                result = GridHit {item.owner, distance};
+            }
+        }
+    });
+    return result;
+}
+
+// Table hit index.
+
+TableHitIndex::TableHitIndex(
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const std::vector<std::string>& filter,
+    IpaSymbols* ipaSymbols,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs)
+    : columns(columns),
+      rows(rows),
+      layout(columns, rows, filter, ipaSymbols, graphs),
+      grid(2 * CELL_SYMBOL_SIZE),
+      cellElements(columns.size() * rows.size()),
+      cellItems(columns.size() * rows.size()) {
+
+    // Grid cells are of the size of the symbol square, so that an element
+    // stroke is registered in a few of them.
+    for (unsigned i = 0; i < rows.size(); i++) {
+        for (unsigned j = 0; j < columns.size(); j++) {
+            addCellSymbol(i, j, graphs);
+        }
+    }
+}
+
+void TableHitIndex::addCellSymbol(
+    unsigned row,
+    unsigned column,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    unsigned cell = row * columns.size() + column;
+    if (not hasIpaSymbol(layout.cellSymbols[cell])) {
+        return;
+    }
+
+    // Descriptors are collected like in `getDescriptors`, so that the element
+    // index is the index of the descriptor.
+    std::vector<std::pair<std::string, std::string>>& elements
+        = cellElements[cell];
+    elements.clear();
+    for (std::string feature : split(columns[column] + ";" + rows[row], ';')) {
+        auto graph = graphs.find(feature);
+        if (graph == graphs.end()) {
+            continue;
+        }
+        for (std::string descriptor : graph->second) {
+            if (descriptor != ".") {
+                elements.push_back({descriptor, feature});
+            }
+        }
+    }
+
+    std::pair<Symbol, SymbolStyle> pair
+        = parseSymbolParameters(layout.cellDescriptors[cell]);
+    Vector center
+        = layout.getCellCenter(row, column) + Vector(CELL_SYMBOL_SHIFT, 0);
+
+    for (unsigned i = 0; i < pair.first.getElementCount(); i++) {
+        for (const Primitive& primitive : pair.first.elementPrimitives(
+                 i, pair.second, center, CELL_SYMBOL_SIZE)) {
+            cellItems[cell].push_back(
+                grid.add(primitive, cell * MAX_SYMBOL_ELEMENTS + i));
+        }
+    }
+}
+
+const TableLayout& TableHitIndex::getLayout() const {
+    return layout;
+}
+
+std::optional<TableHit>
+TableHitIndex::find(Vector point, float maximumDistance) const {
+
+    TableHit hit;
+    std::optional<GridHit> gridHit = grid.findClosest(point, maximumDistance);
+
+    if (gridHit) {
+        unsigned cell = gridHit->owner / MAX_SYMBOL_ELEMENTS;
+        hit.row = cell / columns.size();
+        hit.column = cell % columns.size();
+        hit.element = gridHit->owner % MAX_SYMBOL_ELEMENTS;
+        hit.descriptor = cellElements[cell][hit.element].first;
+        hit.feature = cellElements[cell][hit.element].second;
+        hit.distance = gridHit->distance;
+    } else {
+        // Column borders increase, row borders decrease.
+        const std::vector<float>& xs = layout.xs;
+        const std::vector<float>& ys = layout.ys;
+        if (point.x < xs.front() or point.x > xs.back()
+            or point.y > ys.front() or point.y < ys.back()) {
+            return std::nullopt;
+        }
+        auto x = std::upper_bound(xs.begin(), xs.end(), point.x);
+        auto y
+            = std::upper_bound(ys.begin(), ys.end(), point.y, std::greater());
+        hit.column = std::min<size_t>(x - xs.begin(), columns.size()) - 1;
+        hit.row = std::min<size_t>(y - ys.begin(), rows.size()) - 1;
+    }
+    hit.ipaSymbol = layout.cellSymbols[hit.row * columns.size() + hit.column];
+    return hit;
+}
+
+void TableHitIndex::updateCell(
+    unsigned row,
+    unsigned column,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    unsigned cell = row * columns.size() + column;
+    for (unsigned item : cellItems[cell]) {
+        grid.remove(item);
+    }
+    cellItems[cell].clear();
+    cellElements[cell].clear();
+
+    if (not hasIpaSymbol(layout.cellSymbols[cell])) {
+        return;
+    }
+    layout.cellDescriptors[cell]
+        = getDescriptors(columns[column] + ";" + rows[row], graphs);
+    addCellSymbol(row, column, graphs);
+}
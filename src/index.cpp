@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "index.hpp"
+#include "util.hpp"
+
+static const char MAGIC[8] = {'F', 'E', 'A', 'T', 'I', 'D', 'X', '\0'};
+static const uint32_t VERSION = 1;
+
+/* FNV-1a hash of the file content. */
+static uint64_t hashFile(const std::string& path) {
+
+    std::ifstream file(path, std::ios::binary);
+    if (not file.is_open()) {
+        throw std::invalid_argument("Could not open the file " + path + ".");
+    }
+    uint64_t hash = 14695981039346656037ull;
+    char chunk[1 << 16];
+
+    while (file.read(chunk, sizeof(chunk)) or file.gcount() > 0) {
+        for (std::streamsize i = 0; i < file.gcount(); i++) {
+            hash ^= static_cast<unsigned char>(chunk[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+/* Modification time and size of the file, hash is computed on demand. */
+static SourceStamp getStamp(const std::string& path) {
+
+    std::error_code timeError;
+    std::error_code sizeError;
+    auto modified = std::filesystem::last_write_time(path, timeError);
+    uintmax_t size = std::filesystem::file_size(path, sizeError);
+    if (timeError or sizeError) {
+        throw std::invalid_argument("Could not open the file " + path + ".");
+    }
+    return {modified.time_since_epoch().count(), size, 0};
+}
+
+/*
+ * Check that the source is unchanged. If only the modification time changed,
+ * compare content hashes and update the stamp.
+ */
+static bool isUpToDate(
+    const std::string& path, SourceStamp& stamp, const SourceStamp& stored) {
+
+    if (stamp.size != stored.size) {
+        return false;
+    }
+    if (stamp.modified == stored.modified) {
+        stamp.hash = stored.hash;
+        return true;
+    }
+    stamp.hash = hashFile(path);
+    return stamp.hash == stored.hash;
+}
+
+/* Check that the section with entries of given size is inside the data. */
+static bool isInside(IndexSection section, size_t entrySize, size_t size) {
+    return section.offset <= size
+        and section.count <= (size - section.offset) / entrySize;
+}
+
+DataIndex::DataIndex(
+    const std::string& graphsPath, const std::string& tablesPath) {
+
+    path = (std::filesystem::path(tablesPath).parent_path() / "featural.index")
+               .string();
+
+    SourceStamp graphs = getStamp(graphsPath);
+    SourceStamp tables = getStamp(tablesPath);
+
+    if (not open(graphsPath, tablesPath, graphs, tables)) {
+        build(graphsPath, tablesPath, graphs, tables);
+    }
+}
+
+DataIndex::~DataIndex() {
+    if (isMapped) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+bool DataIndex::open(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    SourceStamp& graphs,
+    SourceStamp& tables) {
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0
+        or static_cast<size_t>(status.st_size) < sizeof(IndexHeader)) {
+        close(file);
+        return false;
+    }
+    size = status.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const char*>(mapped);
+    isMapped = true;
+
+    const IndexHeader& stored = header();
+    bool isValid = std::memcmp(stored.magic, MAGIC, sizeof(MAGIC)) == 0
+        and stored.version == VERSION
+        and isInside(stored.strings, 1, size)
+        and isInside(stored.graphEntries, sizeof(IndexEntry), size)
+        and isInside(stored.cellEntries, sizeof(IndexEntry), size)
+        and isInside(stored.columnEntries, sizeof(IndexEntry), size)
+        and isInside(stored.rowEntries, sizeof(IndexEntry), size)
+        and isUpToDate(graphsPath, graphs, stored.graphs)
+        and isUpToDate(tablesPath, tables, stored.tables);
+
+    if (not isValid) {
+        munmap(mapped, size);
+        data = nullptr;
+        size = 0;
+        isMapped = false;
+        return false;
+    }
+
+    // Sources were touched but not changed, store new modification times so
+    // that the next run doesn't hash them again.
+    if (graphs.modified != stored.graphs.modified
+        or tables.modified != stored.tables.modified) {
+
+        IndexHeader updated = stored;
+        updated.graphs = graphs;
+        updated.tables = tables;
+        std::string content(data, size);
+        std::memcpy(content.data(), &updated, sizeof(updated));
+        store(content);
+    }
+    return true;
+}
+
+void DataIndex::store(const std::string& content) const {
+
+    // Write to a temporary file and rename it, so that concurrent runs never
+    // see a partially written index.
+    std::string temporaryPath = path + "." + std::to_string(getpid());
+    std::ofstream file(temporaryPath, std::ios::binary);
+    file.write(content.data(), content.size());
+    file.close();
+    if (not file.fail()) {
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (not error) {
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::remove(temporaryPath, error);
+    std::cerr << "Cannot write index " << path << "." << std::endl;
+}
+
+void DataIndex::build(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    SourceStamp graphs,
+    SourceStamp tables) {
+
+    std::unordered_map<std::string, std::vector<std::string>> parsedGraphs
+        = parseGraphs(graphsPath);
+    std::unique_ptr<IpaSymbols> ipaSymbols(parseTables(tablesPath));
+
+    graphs.hash = hashFile(graphsPath);
+    tables.hash = hashFile(tablesPath);
+
+    std::string strings;
+    auto addEntry = [&strings](
+                        std::vector<IndexEntry>& entries,
+                        const std::string& key,
+                        const std::string& value) {
+        IndexEntry entry;
+        entry.keyOffset = strings.size();
+        entry.keyLength = key.size();
+        strings += key;
+        entry.valueOffset = strings.size();
+        entry.valueLength = value.size();
+        strings += value;
+        entries.push_back(entry);
+    };
+
+    // Maps are sorted, so entries can be found by binary search.
+    std::map<std::string, std::string> sortedGraphs;
+    for (auto& [feature, descriptors] : parsedGraphs) {
+        std::string value;
+        for (std::string descriptor : descriptors) {
+            value += (value.empty() ? "" : " ") + descriptor;
+        }
+        sortedGraphs[feature] = value;
+    }
+    std::map<std::string, std::string> sortedCells(
+        ipaSymbols->getSymbols().begin(), ipaSymbols->getSymbols().end());
+
+    std::vector<IndexEntry> graphEntries;
+    std::vector<IndexEntry> cellEntries;
+    std::vector<IndexEntry> columnEntries;
+    std::vector<IndexEntry> rowEntries;
+    for (auto& [feature, descriptors] : sortedGraphs) {
+        addEntry(graphEntries, feature, descriptors);
+    }
+    for (auto& [key, ipaSymbol] : sortedCells) {
+        addEntry(cellEntries, key, ipaSymbol);
+    }
+    for (std::string column : ipaSymbols->columns) {
+        addEntry(columnEntries, column, "");
+    }
+    for (std::string row : ipaSymbols->rows) {
+        addEntry(rowEntries, row, "");
+    }
+
+    // Keep entries aligned after the strings.
+    strings.resize((strings.size() + 3) / 4 * 4, '\0');
+
+    IndexHeader newHeader {};
+    std::memcpy(newHeader.magic, MAGIC, sizeof(MAGIC));
+    newHeader.version = VERSION;
+    newHeader.graphs = graphs;
+    newHeader.tables = tables;
+
+    uint64_t offset = sizeof(IndexHeader);
+    auto place = [&offset](
+                     IndexSection& section, size_t count, size_t entrySize) {
+        section = {offset, count};
+        offset += count * entrySize;
+    };
+    place(newHeader.strings, strings.size(), 1);
+    place(newHeader.graphEntries, graphEntries.size(), sizeof(IndexEntry));
+    place(newHeader.cellEntries, cellEntries.size(), sizeof(IndexEntry));
+    place(newHeader.columnEntries, columnEntries.size(), sizeof(IndexEntry));
+    place(newHeader.rowEntries, rowEntries.size(), sizeof(IndexEntry));
+
+    buffer.reserve(offset);
+    buffer.append(reinterpret_cast<const char*>(&newHeader), sizeof(newHeader));
+    buffer += strings;
+    for (std::vector<IndexEntry>* entries :
+         {&graphEntries, &cellEntries, &columnEntries, &rowEntries}) {
+        buffer.append(
+            reinterpret_cast<const char*>(entries->data()),
+            entries->size() * sizeof(IndexEntry));
+    }
+    data = buffer.data();
+    size = buffer.size();
+    store(buffer);
+}
+
+const IndexHeader& DataIndex::header() const {
+    return *reinterpret_cast<const IndexHeader*>(data);
+}
+
+std::string_view DataIndex::getString(uint32_t offset, uint32_t length) const {
+    if (static_cast<uint64_t>(offset) + length > header().strings.count) {
+        throw std::invalid_argument("Index " + path + " is corrupted.");
+    }
+    return std::string_view(data + header().strings.offset + offset, length);
+}
+
+bool DataIndex::find(
+    IndexSection section,
+    std::string_view key,
+    std::string_view& value) const {
+
+    const IndexEntry* entries
+        = reinterpret_cast<const IndexEntry*>(data + section.offset);
+    const IndexEntry* end = entries + section.count;
+
+    auto isLess = [this](const IndexEntry& entry, std::string_view key) {
+        return getString(entry.keyOffset, entry.keyLength) < key;
+    };
+    const IndexEntry* entry = std::lower_bound(entries, end, key, isLess);
+    if (entry == end or getString(entry->keyOffset, entry->keyLength) != key) {
+        return false;
+    }
+    value = getString(entry->valueOffset, entry->valueLength);
+    return true;
+}
+
+std::vector<std::string> DataIndex::getKeys(IndexSection section) const {
+
+    const IndexEntry* entries
+        = reinterpret_cast<const IndexEntry*>(data + section.offset);
+    std::vector<std::string> keys;
+
+    for (uint64_t i = 0; i < section.count; i++) {
+        keys.emplace_back(
+            getString(entries[i].keyOffset, entries[i].keyLength));
+    }
+    return keys;
+}
+
+bool DataIndex::findGraph(
+    std::string_view feature, std::vector<std::string>& result) const {
+
+    std::string_view value;
+    if (not find(header().graphEntries, feature, value)) {
+        return false;
+    }
+    result = split(std::string(value), ' ');
+    return true;
+}
+
+std::string DataIndex::findSymbol(std::string_view key) const {
+    std::string_view value;
+    if (find(header().cellEntries, key, value)) {
+        return std::string(value);
+    }
+    return " ";
+}
+
+std::vector<std::string> DataIndex::getColumns() const {
+    return getKeys(header().columnEntries);
+}
+
+std::vector<std::string> DataIndex::getRows() const {
+    return getKeys(header().rowEntries);
+}
+
+std::unordered_map<std::string, std::vector<std::string>>
+DataIndex::loadGraphs(const std::vector<std::string>& parameters) const {
+
+    std::unordered_map<std::string, std::vector<std::string>> graphs;
+
+    for (std::string parameter : parameters) {
+        for (std::string feature : split(parameter, ';')) {
+            std::vector<std::string> descriptors;
+            if (not graphs.contains(feature)
+                and findGraph(feature, descriptors)) {
+                graphs[feature] = descriptors;
+            }
+        }
+    }
+    return graphs;
+}
+
+IpaSymbols* DataIndex::loadSymbols(
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows) const {
+
+    IpaSymbols* ipaSymbols = new IpaSymbols();
+
+    for (std::string row : rows) {
+        for (std::string column : columns) {
+            std::string parameters = column + ";" + row;
+            std::string key = sortParameters(parameters);
+            std::string_view value;
+            if (find(header().cellEntries, key, value)) {
+                ipaSymbols->add(parameters, std::string(value));
+            }
+        }
+    }
+    return ipaSymbols;
+}
@@ -1,84 +1,478 @@
-#include <fstream>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 
+#include "chart.hpp"
+#include "check.hpp"
+#include "filter.hpp"
+#include "font.hpp"
 #include "geometry.hpp"
+#include "hit.hpp"
+#include "index.hpp"
+#include "query.hpp"
+#include "run.hpp"
+#include "similar.hpp"
 #include "symbol.hpp"
 #include "util.hpp"
 #include "visual.hpp"
+#include "watch.hpp"
 
-IpaSymbols* parseTables(const std::string& path) {
+void drawTable(
+    std::vector<std::string> rows,
+    std::vector<std::string> columns,
+    std::vector<std::string> filter,
+    PainterStyle painterStyle) {
+
+    // Load only graphs and symbols of the requested rows and columns.
+    DataIndex index("data/graphs.txt", "data/consonants.txt");
+    std::vector<std::string> parameters = rows;
+    parameters.insert(parameters.end(), columns.begin(), columns.end());
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = index.loadGraphs(parameters);
+    std::unique_ptr<IpaSymbols> ipaSymbols(index.loadSymbols(rows, columns));
+    visitPainter(painterStyle, [&](auto& painter) {
+        drawTable(painter, rows, columns, filter, ipaSymbols.get(), graphs);
+        painter.end();
+        std::cout << painter.getString();
+    });
+}
+
+/*
+ * Draw the table in pages, see `ChartAxis` for the axis syntax. Arguments are
+ * in the order of `table`: `rows` are drawn as the columns of pages, and
+ * `columns` as their rows.
+ */
+void drawChart(
+    std::string rows,
+    std::string columns,
+    std::vector<std::string> filter,
+    std::vector<std::string> options) {
+
+    // The feature dictionary is parsed only if an axis uses it.
+    std::unordered_map<std::string, std::vector<std::string>> dictionary;
+    if (rows.find(':') != std::string::npos
+        or columns.find(':') != std::string::npos) {
+        dictionary
+            = getChartDictionary("data/graphs.txt", "data/consonants.txt");
+    }
+    unsigned pageCount = drawChart(
+        "data/graphs.txt",
+        "data/consonants.txt",
+        ChartAxis(columns, dictionary),
+        ChartAxis(rows, dictionary),
+        filter,
+        PainterStyle(options),
+        ChartStyle(options));
+    std::cerr << "Chart: " << pageCount << " pages." << std::endl;
+}
+
+/*
+ * Draw the main table for every inventory of the file into the directory.
+ * Options are painter style options and `t=` (number of threads).
+ */
+void drawInventoryCharts(
+    std::string path, std::string directory, std::vector<std::string> options) {
+
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (std::string option : options) {
+        std::vector<std::string> keyValue = split(option, '=');
+        if (keyValue.size() == 2 and keyValue[0] == "t") {
+            threadCount = std::stoi(keyValue[1]);
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Inventory> inventories = parseInventories(path);
+    size_t glyphCount = drawInventoryCharts(
+        "data/graphs.txt",
+        "data/consonants.txt",
+        inventories,
+        PainterStyle(options),
+        directory,
+        threadCount);
+
+    std::cerr << "Charts: " << inventories.size() << " inventories, "
+              << glyphCount << " glyphs, " << threadCount << " threads, "
+              << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()
+              << " ms." << std::endl;
+}
 
-    IpaSymbols* ipaSymbols = new IpaSymbols();
+void drawSymbol(std::vector<std::string> parameters) {
+
+    std::pair<Symbol, SymbolStyle> pair = parseSymbolParameters(parameters);
+    Symbol symbol = pair.first;
+    SymbolStyle style = pair.second;
+    visitPainter(PainterStyle(parameters), [&](auto& painter) {
+        symbol.draw(painter, style, Vector(0, 0), 0.1f);
+        painter.end();
+        std::cout << painter.getString();
+    });
+}
 
-    std::ifstream inFile(path);
+/*
+ * Write TrueType font with glyphs of all IPA symbols of the consonants file
+ * and list their code points. Arguments with `=` are symbol style options.
+ */
+void writeFont(std::string path, std::vector<std::string> options) {
 
-    std::string line;
-    std::getline(inFile, line);
-    std::vector<std::string> columns = split(line, ' ');
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = parseGraphs("data/graphs.txt");
+    IpaSymbols* ipaSymbols = parseTables("data/consonants.txt");
+    SymbolStyle style(options);
 
-    while (std::getline(inFile, line)) {
+    // Sort cells, so that code points don't change between runs.
+    std::map<std::string, std::string> cells(
+        ipaSymbols->getSymbols().begin(), ipaSymbols->getSymbols().end());
+    delete ipaSymbols;
 
-        if (line.empty()) {
-            std::getline(inFile, line);
-            columns = split(line, ' ');
+    // Code points are listed after the font is written, so that the file
+    // exists even if the output is closed early.
+    std::vector<FontGlyph> glyphs;
+    std::ostringstream codePoints;
+    for (auto& [parameters, ipaSymbol] : cells) {
+        if (ipaSymbol == "-" or ipaSymbol == "=" or ipaSymbol == " ") {
             continue;
         }
-        std::vector<std::string> parts = split(line, ' ');
-        std::string row = parts[0];
+        uint32_t codePoint = FONT_FIRST_CODE_POINT + glyphs.size();
+        glyphs.push_back(createFontGlyph(
+            Symbol(getDescriptors(parameters, graphs)), style, codePoint));
+
+        codePoints << "U+" << std::hex << std::uppercase << codePoint
+                   << std::dec << " " << parameters << " " << ipaSymbol
+                   << std::endl;
+    }
+    writeFont(path, "Featural", glyphs);
+    std::cout << codePoints.str();
+}
+
+/*
+ * Find glyphs similar to the glyph of the parameters, or the most similar
+ * pairs of glyphs if there are no parameters. Glyphs with equal feature
+ * vectors are grouped. Arguments with `=` are options: `k=` (number of
+ * neighbors) and `n=` (number of pairs).
+ */
+void similar(std::vector<std::string> arguments) {
+
+    unsigned k = 10;
+    unsigned count = 20;
+    std::string query;
+    for (std::string argument : arguments) {
+        std::vector<std::string> keyValue = split(argument, '=');
+        if (argument.find('=') == std::string::npos) {
+            query = argument;
+        } else if (keyValue.size() == 2 and keyValue[0] == "k") {
+            k = std::stoi(keyValue[1]);
+        } else if (keyValue.size() == 2 and keyValue[0] == "n") {
+            count = std::stoi(keyValue[1]);
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = parseGraphs("data/graphs.txt");
+    std::unique_ptr<IpaSymbols> ipaSymbols(parseTables("data/consonants.txt"));
+    FeatureSpace space(graphs, ipaSymbols.get());
+    GlyphGroups groups(space.getCombinations(), graphs, *ipaSymbols);
+    const SimilarityIndex& index = groups.getIndex();
 
-        for (unsigned i = 1; i < parts.size(); i++) {
+    std::cout << "Combinations: " << groups.getCombinationCount()
+              << ", distinct glyphs: " << index.size() << "." << std::endl
+              << std::endl;
 
-            std::string parameters = columns[i - 1] + ';' + row;
-            ipaSymbols->add(parameters, parts[i]);
+    if (query.empty()) {
+        std::cout << "Most similar pairs:" << std::endl;
+        for (SimilarPair pair : index.findClosestPairs(count)) {
+            std::cout << "    " << std::fixed << std::setprecision(4)
+                      << pair.distance << "  " << index.getName(pair.first)
+                      << " ~ " << index.getName(pair.second) << std::endl;
+        }
+    } else {
+        std::cout << "Nearest to " << groups.getName(query) << ":"
+                  << std::endl;
+        for (Neighbor neighbor : groups.findNearest(query, graphs, k)) {
+            std::cout << "    " << std::fixed << std::setprecision(4)
+                      << neighbor.distance << "  "
+                      << index.getName(neighbor.index) << std::endl;
         }
     }
-    return ipaSymbols;
+    std::cerr << "Similarity search: "
+              << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()
+              << " ms." << std::endl;
 }
 
-void drawTable(
+/*
+ * Print the table cell and the symbol element under every point `x,y` of the
+ * table drawn with the rows, columns, and filter. Option `d=` is the maximum
+ * distance to an element stroke (0.02 by default).
+ */
+void hit(
     std::vector<std::string> rows,
     std::vector<std::string> columns,
-    std::vector<std::string> filter) {
+    std::vector<std::string> filter,
+    std::vector<std::string> arguments) {
+
+    float maximumDistance = 0.02f;
+    std::vector<Vector> points;
+    for (std::string argument : arguments) {
+        std::vector<std::string> keyValue = split(argument, '=');
+        if (keyValue.size() == 2 and keyValue[0] == "d") {
+            maximumDistance = parseFloat(keyValue[1]);
+        } else if (argument.find('=') == std::string::npos) {
+            std::vector<std::string> coordinates = split(argument, ',');
+            if (coordinates.size() != 2) {
+                throw std::invalid_argument(
+                    "Point should be `x,y`, got `" + argument + "`.");
+            }
+            points.push_back(Vector(
+                parseFloat(coordinates[0]), parseFloat(coordinates[1])));
+        }
+    }
+
+    DataIndex dataIndex("data/graphs.txt", "data/consonants.txt");
+    std::vector<std::string> parameters = rows;
+    parameters.insert(parameters.end(), columns.begin(), columns.end());
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = dataIndex.loadGraphs(parameters);
+    IpaSymbols* ipaSymbols = dataIndex.loadSymbols(rows, columns);
+
+    auto start = std::chrono::steady_clock::now();
+    TableHitIndex index(rows, columns, filter, ipaSymbols, graphs);
+    auto built = std::chrono::steady_clock::now();
+    delete ipaSymbols;
+
+    std::vector<std::optional<TableHit>> hits;
+    for (Vector point : points) {
+        hits.push_back(index.find(point, maximumDistance));
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (unsigned i = 0; i < points.size(); i++) {
+        std::cout << points[i].x << "," << points[i].y << ": ";
+        if (not hits[i]) {
+            std::cout << "outside" << std::endl;
+            continue;
+        }
+        const TableHit& hit = *hits[i];
+        std::cout << "row " << hit.row << ", column " << hit.column << " `"
+                  << hit.ipaSymbol << "`";
+        if (hit.element >= 0) {
+            std::cout << ", element " << hit.element << " " << hit.descriptor
+                      << " (" << hit.feature << "), distance "
+                      << hit.distance;
+        }
+        std::cout << std::endl;
+    }
+    double queryTime
+        = std::chrono::duration<double, std::micro>(end - built).count()
+        / std::max<size_t>(points.size(), 1);
+    std::cerr << "Index: "
+              << std::chrono::duration<double, std::milli>(built - start)
+                     .count()
+              << " ms, query: " << queryTime << " µs." << std::endl;
+}
+
+/*
+ * Print inventory cells matching the boolean expression over features and
+ * element descriptors, see `QueryExpression`.
+ */
+void query(std::string expression) {
 
     std::unordered_map<std::string, std::vector<std::string>> graphs
         = parseGraphs("data/graphs.txt");
     IpaSymbols* ipaSymbols = parseTables("data/consonants.txt");
-    drawTable(
-        new TikzPainter("out/ipa_table.tex"),
-        rows,
-        columns,
-        filter,
-        ipaSymbols,
-        graphs);
+    InventoryIndex index(graphs, *ipaSymbols);
+    delete ipaSymbols;
+
+    auto start = std::chrono::steady_clock::now();
+    Bitset cells = index.query(QueryExpression(expression));
+    auto end = std::chrono::steady_clock::now();
+
+    for (size_t cell : cells.getIndices()) {
+        std::cout << index.getIpaSymbol(cell) << " " << index.getCell(cell)
+                  << std::endl;
+    }
+    std::cout << cells.count() << " of " << index.size() << " cells."
+              << std::endl;
+    std::cerr << "Query: "
+              << std::chrono::duration<double, std::micro>(end - start).count()
+              << " µs." << std::endl;
 }
 
-void drawSymbol(std::vector<std::string> parameters) {
-    Painter* painter = new TikzPainter("out/ipa_table.tex");
+/*
+ * Render the main table with all symbols `repetitions` times through the
+ * type-erased `Painter` and through `TikzPainter`, and compare the time: of
+ * whole tables, and of emission only, by replaying recorded primitives.
+ */
+void bench(unsigned repetitions) {
 
-    std::pair<Symbol, SymbolStyle> pair = parseSymbolParameters(parameters);
-    Symbol symbol = pair.first;
-    SymbolStyle style = pair.second;
-    symbol.draw(painter, style, Vector(0, 0), 0.1f);
+    DataIndex index("data/graphs.txt", "data/consonants.txt");
+    std::vector<std::string> rows = index.getRows();
+    std::vector<std::string> columns = index.getColumns();
+    std::vector<std::string> parameters = rows;
+    parameters.insert(parameters.end(), columns.begin(), columns.end());
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = index.loadGraphs(parameters);
+    std::unique_ptr<IpaSymbols> ipaSymbols(index.loadSymbols(columns, rows));
+
+    std::vector<std::string> filter;
+    for (auto& [key, ipaSymbol] : ipaSymbols->getSymbols()) {
+        filter.push_back(ipaSymbol);
+    }
+
+    RecordingPainter recording;
+    drawTable(recording, columns, rows, filter, ipaSymbols.get(), graphs);
+    const std::vector<Primitive>& primitives = recording.primitives;
+
+    // Output size is compared, so that neither loop can be optimized out.
+    auto measure = [&](std::string name, auto render) {
+        size_t size = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < repetitions; i++) {
+            size += render();
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        std::cout << std::left << std::setw(20) << name << std::fixed
+                  << std::setprecision(3) << ms / repetitions << " ms/table, "
+                  << std::setprecision(1)
+                  << 1e6 * ms / repetitions / primitives.size()
+                  << " ns/primitive" << std::endl;
+        return size;
+    };
+    auto render = [&](auto& painter) {
+        drawTable(painter, columns, rows, filter, ipaSymbols.get(), graphs);
+        painter.end();
+        return painter.getString().size();
+    };
+    auto emit = [&](auto& painter) {
+        for (const Primitive& primitive : primitives) {
+            replay(primitive, painter);
+        }
+        painter.end();
+        return painter.getString().size();
+    };
+    std::cout << primitives.size() << " primitives, " << repetitions
+              << " repetitions" << std::endl;
+
+    size_t sizes[4] = {
+        measure("table Painter", [&]() {
+            TikzPainter painter("");
+            return render(static_cast<Painter&>(painter));
+        }),
+        measure("table TikzPainter", [&]() {
+            TikzPainter painter("");
+            return render(painter);
+        }),
+        measure("emit Painter", [&]() {
+            TikzPainter painter("");
+            return emit(static_cast<Painter&>(painter));
+        }),
+        measure("emit TikzPainter", [&]() {
+            TikzPainter painter("");
+            return emit(painter);
+        })};
+    // Replayed primitives are already shifted, so the sizes of tables and of
+    // replays are compared separately.
+    if (sizes[0] != sizes[1] or sizes[2] != sizes[3]) {
+        throw std::invalid_argument("Painters produced different output.");
+    }
+}
+
+/*
+ * Draw words in lines. Arguments with `=` are options, the rest are words.
+ */
+void drawRun(std::vector<std::string> arguments) {
+
+    std::vector<std::string> words;
+    std::vector<std::string> options;
+    for (std::string argument : arguments) {
+        if (argument.find('=') != std::string::npos) {
+            options.push_back(argument);
+        } else {
+            words.push_back(argument);
+        }
+    }
+    // The painter is deleted (and its threads are joined) even if the run
+    // can't be drawn.
+    std::unique_ptr<Painter> painter(createPainter(PainterStyle(options)));
+    drawRun(
+        painter.get(),
+        parseRun(words),
+        SymbolStyle(options),
+        RunStyle(options));
     painter->end();
     std::cout << painter->getString();
 }
 
+/*
+ * Check that all combinations of places, manners, and phonations have distinct
+ * symbols. Returns the number of collisions.
+ */
+unsigned check() {
+
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = parseGraphs("data/graphs.txt");
+    std::unique_ptr<IpaSymbols> ipaSymbols(parseTables("data/consonants.txt"));
+
+    FeatureSpace space(graphs, ipaSymbols.get());
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Glyph> glyphs = computeGlyphs(
+        space.getCombinations(), graphs, ipaSymbols.get(), threadCount);
+
+    return checkGlyphs(glyphs, std::cout);
+}
+
 int main(int argc, char** argv) {
 
     try {
         if (std::string(argv[1]) == "table") {
-            if (argc != 5) {
-                std::cerr << "`table` command should have exactly two "
-                             "arguments: rows and columns."
+            if (argc < 5) {
+                std::cerr << "`table` command should have three arguments: "
+                             "rows, columns, and filter."
                           << std::endl;
                 return 1;
             }
             std::vector<std::string> rows = split(argv[2], ',');
             std::vector<std::string> columns = split(argv[3], ',');
             std::vector<std::string> filter = split(argv[4], ',');
+            std::vector<std::string> options(argv + 5, argv + argc);
 
-            drawTable(rows, columns, filter);
+            drawTable(rows, columns, filter, PainterStyle(options));
+
+        } else if (std::string(argv[1]) == "chart") {
+            if (argc < 5) {
+                std::cerr << "`chart` command should have three arguments: "
+                             "rows, columns, and filter."
+                          << std::endl;
+                return 1;
+            }
+            drawChart(
+                argv[2],
+                argv[3],
+                split(argv[4], ','),
+                std::vector<std::string>(argv + 5, argv + argc));
+
+        } else if (std::string(argv[1]) == "charts") {
+            if (argc < 4) {
+                std::cerr << "`charts` command should have two arguments: "
+                             "inventories file and output directory."
+                          << std::endl;
+                return 1;
+            }
+            drawInventoryCharts(
+                argv[2],
+                argv[3],
+                std::vector<std::string>(argv + 4, argv + argc));
 
         } else if (std::string(argv[1]) == "symbol") {
             std::vector<std::string> parameters;
@@ -87,8 +481,61 @@ int main(int argc, char** argv) {
             }
             drawSymbol(parameters);
 
+        } else if (std::string(argv[1]) == "run") {
+            drawRun(std::vector<std::string>(argv + 2, argv + argc));
+
+        } else if (std::string(argv[1]) == "watch") {
+            if (argc < 3) {
+                std::cerr << "`watch` command should have the table "
+                             "specification file argument."
+                          << std::endl;
+                return 1;
+            }
+            watch("data/graphs.txt", "data/consonants.txt", argv[2]);
+
+        } else if (std::string(argv[1]) == "check") {
+            return check() == 0 ? 0 : 1;
+
+        } else if (std::string(argv[1]) == "font") {
+            if (argc < 3) {
+                std::cerr << "`font` command should have the output file "
+                             "argument."
+                          << std::endl;
+                return 1;
+            }
+            writeFont(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+
+        } else if (std::string(argv[1]) == "similar") {
+            similar(std::vector<std::string>(argv + 2, argv + argc));
+
+        } else if (std::string(argv[1]) == "hit") {
+            if (argc < 5) {
+                std::cerr << "`hit` command should have three arguments: "
+                             "rows, columns, and filter."
+                          << std::endl;
+                return 1;
+            }
+            hit(split(argv[2], ','),
+                split(argv[3], ','),
+                split(argv[4], ','),
+                std::vector<std::string>(argv + 5, argv + argc));
+
+        } else if (std::string(argv[1]) == "query") {
+            if (argc < 3) {
+                std::cerr << "`query` command should have the expression "
+                             "argument."
+                          << std::endl;
+                return 1;
+            }
+            query(argv[2]);
+
+        } else if (std::string(argv[1]) == "bench") {
+            bench(argc > 2 ? std::stoi(argv[2]) : 100);
+
         } else {
-            std::cerr << "First argument should be `table` or `symbol`."
+            std::cerr << "First argument should be `table`, `chart`, "
+                         "`charts`, `symbol`, `run`, `watch`, `check`, "
+                         "`similar`, `font`, `query`, `hit`, or `bench`."
                       << std::endl;
             return 1;
         }
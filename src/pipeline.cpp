@@ -0,0 +1,209 @@
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "pipeline.hpp"
+#include "visual.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+/* Push item to the queue, sleep while the queue is full. */
+template <typename T, size_t Capacity>
+static void push(SpscQueue<T, Capacity>& queue, T& item, StageTime& time) {
+    if (queue.tryPush(item)) {
+        return;
+    }
+    Clock::time_point waitStart = Clock::now();
+    queue.push(item);
+    time.waiting += Clock::now() - waitStart;
+}
+
+/* Pop item from the queue, sleep while the queue is empty. */
+template <typename T, size_t Capacity>
+static void pop(SpscQueue<T, Capacity>& queue, T& item, StageTime& time) {
+    if (queue.tryPop(item)) {
+        return;
+    }
+    Clock::time_point waitStart = Clock::now();
+    queue.pop(item);
+    time.waiting += Clock::now() - waitStart;
+}
+
+PipelinePainter::PipelinePainter(std::string format, int fileDescriptor)
+    : format(format), fileDescriptor(fileDescriptor) {
+
+    // Check the format before starting threads.
+    delete createPainter(PainterStyle({"f=" + format}));
+
+    start = Clock::now();
+    batch.reserve(BATCH_SIZE);
+    formatThread = std::thread(&PipelinePainter::formatBatches, this);
+    writeThread = std::thread(&PipelinePainter::writeChunks, this);
+}
+
+PipelinePainter::~PipelinePainter() {
+    end();
+}
+
+std::string PipelinePainter::getString() {
+    return "";
+}
+
+void PipelinePainter::add(Primitive primitive) {
+    batch.push_back(primitive);
+    primitiveCount++;
+    if (batch.size() == BATCH_SIZE) {
+        sendBatch();
+    }
+}
+
+void PipelinePainter::sendBatch() {
+    push(batches, batch, geometryTime);
+    batch = std::vector<Primitive>();
+    batch.reserve(BATCH_SIZE);
+    batchCount++;
+}
+
+/* Format thread: convert batches into code, empty batch ends the stream. */
+void PipelinePainter::formatBatches() {
+
+    std::vector<Primitive> formatBatch;
+
+    while (true) {
+        pop(batches, formatBatch, formatTime);
+        if (formatBatch.empty()) {
+            std::string endChunk;
+            push(chunks, endChunk, formatTime);
+            return;
+        }
+        Clock::time_point workStart = Clock::now();
+        std::string chunk;
+        visitPainter(PainterStyle({"f=" + format}), [&](auto& painter) {
+            for (const Primitive& primitive : formatBatch) {
+                replay(primitive, painter);
+            }
+            chunk = painter.getString();
+        });
+        formatTime.busy += Clock::now() - workStart;
+
+        push(chunks, chunk, formatTime);
+    }
+}
+
+/* Write thread: collect chunks into large buffers, empty chunk ends. */
+void PipelinePainter::writeChunks() {
+
+    std::string buffer;
+    buffer.reserve(2 * WRITE_SIZE);
+    std::string chunk;
+
+    while (true) {
+        pop(chunks, chunk, writeTime);
+        if (chunk.empty()) {
+            writeBuffer(buffer);
+            return;
+        }
+        buffer += chunk;
+        if (buffer.size() >= WRITE_SIZE) {
+            writeBuffer(buffer);
+            buffer.clear();
+        }
+    }
+}
+
+void PipelinePainter::writeBuffer(const std::string& buffer) {
+
+    Clock::time_point workStart = Clock::now();
+    size_t written = 0;
+
+    while (written < buffer.size()) {
+        ssize_t result = write(
+            fileDescriptor, buffer.data() + written, buffer.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Cannot write output: " << std::strerror(errno)
+                      << std::endl;
+            break;
+        }
+        written += result;
+        writeCount++;
+    }
+    byteCount += written;
+    writeTime.busy += Clock::now() - workStart;
+}
+
+/* Write utilization of the stage in the report. */
+static void writeStage(
+    std::string name, StageTime time, Clock::duration total) {
+
+    auto toMs = [](Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    std::cerr << "    " << std::left << std::setw(10) << name << std::fixed
+              << std::setprecision(2) << "busy " << toMs(time.busy) << " ms ("
+              << std::setprecision(0) << 100 * toMs(time.busy) / toMs(total)
+              << "%), waiting " << std::setprecision(2) << toMs(time.waiting)
+              << " ms" << std::endl;
+}
+
+void PipelinePainter::end() {
+
+    if (isEnded) {
+        return;
+    }
+    isEnded = true;
+
+    if (not batch.empty()) {
+        sendBatch();
+    }
+    // Time spent in the calling thread, except waiting, is geometry time.
+    geometryTime.busy = Clock::now() - start - geometryTime.waiting;
+
+    std::vector<Primitive> endBatch;
+    push(batches, endBatch, geometryTime);
+    formatThread.join();
+    writeThread.join();
+
+    Clock::duration total = Clock::now() - start;
+    std::cerr << "Pipeline: " << primitiveCount << " primitives in "
+              << batchCount << " batches, " << byteCount << " bytes in "
+              << writeCount << " writes, " << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(total).count()
+              << " ms." << std::endl;
+    writeStage("geometry", geometryTime, total);
+    writeStage("format", formatTime, total);
+    writeStage("write", writeTime, total);
+}
+
+void PipelinePainter::line(
+    Vector point1, Vector point2, const std::string& settings) {
+    add({PrimitiveType::Line, {point1, point2}, 2, settings, ""});
+}
+
+void PipelinePainter::curve(
+    Vector point1,
+    Vector point2,
+    Vector point3,
+    Vector point4,
+    const std::string& settings) {
+    add({PrimitiveType::Curve,
+         {point1, point2, point3, point4},
+         4,
+         settings,
+         ""});
+}
+
+void PipelinePainter::text(
+    Vector center, const std::string& text, const std::string& settings) {
+    add({PrimitiveType::Text, {center}, 1, settings, text});
+}
+
+void PipelinePainter::rectangle(
+    Vector point1, Vector point2, const std::string& settings) {
+    add({PrimitiveType::Rectangle, {point1, point2}, 2, settings, ""});
+}
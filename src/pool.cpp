@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+#include "pool.hpp"
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : threadCount(std::max(1u, threadCount)) { }
+
+bool WorkStealingPool::takeTask(
+    std::vector<Worker>& workers, unsigned worker, size_t& task) {
+
+    {
+        std::lock_guard lock(workers[worker].mutex);
+        if (not workers[worker].tasks.empty()) {
+            task = workers[worker].tasks.front();
+            workers[worker].tasks.pop_front();
+            return true;
+        }
+    }
+    // Tasks are not added while running, so if every deque is empty, there
+    // is nothing left to steal.
+    for (unsigned i = 1; i < workers.size(); i++) {
+        Worker& victim = workers[(worker + i) % workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if (not victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(
+    size_t count, const std::function<void(size_t)>& task) {
+
+    unsigned workerCount = std::min<size_t>(threadCount, count);
+    if (workerCount == 0) {
+        return;
+    }
+
+    // Every worker starts with a contiguous range of tasks.
+    std::vector<Worker> workers(workerCount);
+    for (unsigned i = 0; i < workerCount; i++) {
+        for (size_t j = count * i / workerCount;
+             j < count * (i + 1) / workerCount;
+             j++) {
+            workers[i].tasks.push_back(j);
+        }
+    }
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto work = [&](unsigned worker) {
+        size_t current;
+        while (takeTask(workers, worker, current)) {
+            try {
+                task(current);
+            } catch (...) {
+                std::lock_guard lock(errorMutex);
+                if (not error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workerCount; i++) {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
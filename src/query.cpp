@@ -0,0 +1,345 @@
+#include <bit>
+#include <cctype>
+#include <map>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "query.hpp"
+#include "util.hpp"
+
+// Bitset.
+
+Bitset::Bitset(size_t size) : size(size), words((size + 63) / 64, 0) { }
+
+Bitset Bitset::full(size_t size) {
+    Bitset result(size);
+    return result.flip();
+}
+
+size_t Bitset::getSize() const {
+    return size;
+}
+
+void Bitset::set(size_t index) {
+    words[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+bool Bitset::test(size_t index) const {
+    return (words[index / 64] >> (index % 64)) & 1;
+}
+
+size_t Bitset::count() const {
+    size_t result = 0;
+    for (uint64_t word : words) {
+        result += std::popcount(word);
+    }
+    return result;
+}
+
+std::vector<size_t> Bitset::getIndices() const {
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < words.size(); i++) {
+        // Take the lowest bit until the word is empty.
+        for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+            indices.push_back(i * 64 + std::countr_zero(word));
+        }
+    }
+    return indices;
+}
+
+/*
+ * Apply the operation to words of two sets: `Vector` is called with pairs
+ * of 128-bit registers if SIMD is enabled, `Scalar` with the rest of words.
+ */
+template <typename Vector, typename Scalar>
+static void combine(
+    std::vector<uint64_t>& words,
+    const std::vector<uint64_t>& other,
+    Vector vector,
+    Scalar scalar) {
+
+    if (words.size() != other.size()) {
+        throw std::invalid_argument("Bitsets have different sizes.");
+    }
+    size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 2 <= words.size(); i += 2) {
+        __m128i* target = reinterpret_cast<__m128i*>(words.data() + i);
+        __m128i value = vector(
+            _mm_loadu_si128(target),
+            _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(other.data() + i)));
+        _mm_storeu_si128(target, value);
+    }
+#endif
+
+    for (; i < words.size(); i++) {
+        words[i] = scalar(words[i], other[i]);
+    }
+}
+
+Bitset& Bitset::operator&=(const Bitset& other) {
+    combine(
+        words,
+        other.words,
+        [](auto a, auto b) { return _mm_and_si128(a, b); },
+        [](uint64_t a, uint64_t b) { return a & b; });
+    return *this;
+}
+
+Bitset& Bitset::operator|=(const Bitset& other) {
+    combine(
+        words,
+        other.words,
+        [](auto a, auto b) { return _mm_or_si128(a, b); },
+        [](uint64_t a, uint64_t b) { return a | b; });
+    return *this;
+}
+
+Bitset& Bitset::andNot(const Bitset& other) {
+    // `_mm_andnot_si128` negates its first argument.
+    combine(
+        words,
+        other.words,
+        [](auto a, auto b) { return _mm_andnot_si128(b, a); },
+        [](uint64_t a, uint64_t b) { return a & ~b; });
+    return *this;
+}
+
+Bitset& Bitset::flip() {
+    for (uint64_t& word : words) {
+        word = ~word;
+    }
+    // Keep bits after the size clear, so that counts are correct.
+    if (size % 64 != 0) {
+        words.back() &= (uint64_t(1) << (size % 64)) - 1;
+    }
+    return *this;
+}
+
+// Query expression.
+
+/* Split the text into parentheses, operators, and words. */
+static std::vector<std::string> tokenize(const std::string& text) {
+
+    const std::string special = "()&|!";
+    std::vector<std::string> tokens;
+    size_t i = 0;
+
+    while (i < text.size()) {
+        if (std::isspace(static_cast<unsigned char>(text[i]))) {
+            i++;
+        } else if (special.find(text[i]) != std::string::npos) {
+            tokens.push_back(text.substr(i++, 1));
+        } else {
+            size_t start = i;
+            while (i < text.size()
+                   and not std::isspace(static_cast<unsigned char>(text[i]))
+                   and special.find(text[i]) == std::string::npos) {
+                i++;
+            }
+            tokens.push_back(text.substr(start, i - start));
+        }
+    }
+    return tokens;
+}
+
+QueryExpression::QueryExpression(const std::string& text) {
+
+    std::vector<std::string> tokens = tokenize(text);
+    size_t position = 0;
+
+    auto peek = [&]() {
+        return position < tokens.size() ? tokens[position] : "";
+    };
+    auto add = [&](NodeType type, std::string term, unsigned left,
+                   unsigned right) {
+        nodes.push_back({type, term, left, right});
+        return static_cast<unsigned>(nodes.size() - 1);
+    };
+
+    // Recursive descent: one function per precedence level.
+    std::function<unsigned()> parseOr;
+    std::function<unsigned()> parseUnary = [&]() -> unsigned {
+        std::string token = peek();
+        position++;
+        if (token == "not" or token == "!") {
+            return add(NodeType::Not, "", parseUnary(), 0);
+        }
+        if (token == "(") {
+            unsigned node = parseOr();
+            if (peek() != ")") {
+                throw std::invalid_argument("Expected `)` in query.");
+            }
+            position++;
+            return node;
+        }
+        if (token.empty()) {
+            throw std::invalid_argument("Unexpected end of query.");
+        }
+        if (token == ")" or token == "and" or token == "&"
+            or token == "or" or token == "|") {
+            throw std::invalid_argument(
+                "Expected term in query, got `" + token + "`.");
+        }
+        return add(NodeType::Term, token, 0, 0);
+    };
+    auto parseAnd = [&]() {
+        unsigned node = parseUnary();
+        while (peek() == "and" or peek() == "&") {
+            position++;
+            node = add(NodeType::And, "", node, parseUnary());
+        }
+        return node;
+    };
+    parseOr = [&]() {
+        unsigned node = parseAnd();
+        while (peek() == "or" or peek() == "|") {
+            position++;
+            node = add(NodeType::Or, "", node, parseAnd());
+        }
+        return node;
+    };
+
+    root = parseOr();
+    if (position != tokens.size()) {
+        throw std::invalid_argument(
+            "Unexpected `" + tokens[position] + "` in query.");
+    }
+}
+
+std::vector<std::string> QueryExpression::getTerms() const {
+    std::vector<std::string> terms;
+    for (const Node& node : nodes) {
+        if (node.type == NodeType::Term) {
+            terms.push_back(node.term);
+        }
+    }
+    return terms;
+}
+
+Bitset QueryExpression::evaluate(
+    unsigned node,
+    const std::function<Bitset(const std::string&)>& getTerm,
+    size_t size) const {
+
+    const Node& current = nodes[node];
+
+    switch (current.type) {
+    case NodeType::Term:
+        return getTerm(current.term);
+    case NodeType::Not:
+        return evaluate(current.left, getTerm, size).flip();
+    case NodeType::And: {
+        Bitset result = evaluate(current.left, getTerm, size);
+        // `a and not b` doesn't need the complement of `b`.
+        const Node& right = nodes[current.right];
+        if (right.type == NodeType::Not) {
+            return result.andNot(evaluate(right.left, getTerm, size));
+        }
+        return result &= evaluate(current.right, getTerm, size);
+    }
+    case NodeType::Or: {
+        Bitset result = evaluate(current.left, getTerm, size);
+        return result |= evaluate(current.right, getTerm, size);
+    }
+    }
+    return Bitset(size);
+}
+
+Bitset QueryExpression::evaluate(
+    const std::function<Bitset(const std::string&)>& getTerm,
+    size_t size) const {
+    return evaluate(root, getTerm, size);
+}
+
+// Inventory index.
+
+std::vector<std::string> getCellTerms(
+    const std::string& parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    std::vector<std::string> terms;
+    for (std::string feature : split(parameters, ';')) {
+        terms.push_back(feature);
+        auto graph = graphs.find(feature);
+        if (graph == graphs.end()) {
+            continue;
+        }
+        for (std::string descriptor : graph->second) {
+            if (descriptor != ".") {
+                terms.push_back("#" + descriptor);
+            }
+        }
+    }
+    return terms;
+}
+
+bool isKnownTerm(
+    const std::string& term,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    if (not term.starts_with("#")) {
+        return graphs.contains(term);
+    }
+    for (auto& [feature, descriptors] : graphs) {
+        for (const std::string& descriptor : descriptors) {
+            if (term.substr(1) == descriptor and descriptor != ".") {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+InventoryIndex::InventoryIndex(
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    const IpaSymbols& symbols) {
+
+    // Sort cells, so that results are in the same order on every run.
+    std::map<std::string, std::string> sortedCells;
+    for (auto& [key, ipaSymbol] : symbols.getSymbols()) {
+        if (hasIpaSymbol(ipaSymbol)) {
+            sortedCells[key] = ipaSymbol;
+        }
+    }
+    for (auto& [key, ipaSymbol] : sortedCells) {
+        cells.push_back(key);
+        ipaSymbols.push_back(ipaSymbol);
+    }
+
+    for (size_t i = 0; i < cells.size(); i++) {
+        for (const std::string& term : getCellTerms(cells[i], graphs)) {
+            postings.try_emplace(term, cells.size()).first->second.set(i);
+        }
+    }
+}
+
+size_t InventoryIndex::size() const {
+    return cells.size();
+}
+
+const std::string& InventoryIndex::getCell(size_t index) const {
+    return cells[index];
+}
+
+const std::string& InventoryIndex::getIpaSymbol(size_t index) const {
+    return ipaSymbols[index];
+}
+
+const Bitset& InventoryIndex::getTermCells(const std::string& term) const {
+    auto it = postings.find(term);
+    if (it == postings.end()) {
+        throw std::invalid_argument("Unknown query term `" + term + "`.");
+    }
+    return it->second;
+}
+
+Bitset InventoryIndex::query(const QueryExpression& expression) const {
+    return expression.evaluate(
+        [this](const std::string& term) { return getTermCells(term); },
+        cells.size());
+}
@@ -0,0 +1,113 @@
+#include "run.hpp"
+#include "util.hpp"
+
+RunStyle::RunStyle(std::vector<std::string> descriptions) {
+    for (std::string description : descriptions) {
+
+        if (description.find('=') == std::string::npos) {
+            continue;
+        }
+        std::vector<std::string> keyValue = split(description, '=');
+        std::string key = keyValue[0];
+        std::string value = keyValue[1];
+
+        if (key == "size") {
+            size = parseFloat(value);
+        } else if (key == "width") {
+            width = parseFloat(value);
+        } else if (key == "ls") {
+            letterSpacing = parseFloat(value);
+        } else if (key == "ws") {
+            wordSpacing = parseFloat(value);
+        } else if (key == "lh") {
+            lineHeight = parseFloat(value);
+        }
+    }
+}
+
+std::vector<std::vector<Symbol>> parseRun(std::vector<std::string> words) {
+
+    std::vector<std::vector<Symbol>> run;
+
+    for (std::string word : words) {
+        std::vector<Symbol> symbols;
+        for (std::string glyph : split(word, ',')) {
+            symbols.push_back(Symbol(split(glyph, ' ')));
+        }
+        if (not symbols.empty()) {
+            run.push_back(symbols);
+        }
+    }
+    return run;
+}
+
+void drawRun(
+    Painter* painter,
+    const std::vector<std::vector<Symbol>>& words,
+    SymbolStyle style,
+    RunStyle runStyle) {
+
+    float unit = runStyle.size * style.zoom;
+    std::string strokeSettings = style.getStrokeSettings();
+    std::string sharedSettings
+        = painter->defineStyle("featural", strokeSettings);
+
+    // Symbols without elements take the width of the symbol square.
+    auto getAdvance = [&](const SymbolMetrics& metrics) {
+        return metrics.ink.isEmpty ? 2 * unit : metrics.advance;
+    };
+
+    float x = 0.0f;
+    float y = 0.0f;
+    bool isLineEmpty = true;
+
+    for (const std::vector<Symbol>& word : words) {
+
+        std::vector<SymbolMetrics> metrics;
+        float wordWidth = unit * runStyle.letterSpacing * (word.size() - 1);
+        for (const Symbol& symbol : word) {
+            metrics.push_back(symbol.getMetrics(style, runStyle.size));
+            wordWidth += getAdvance(metrics.back());
+        }
+
+        // Words are not broken, so a word wider than the line takes the whole
+        // line.
+        if (not isLineEmpty) {
+            float space = unit * runStyle.wordSpacing;
+            if (runStyle.width > 0 and x + space + wordWidth > runStyle.width) {
+                x = 0.0f;
+                y -= unit * runStyle.lineHeight;
+            } else {
+                x += space;
+            }
+        }
+        isLineEmpty = false;
+
+        for (unsigned i = 0; i < word.size(); i++) {
+
+            // Side bearing is half of the line width, the ink box is already
+            // padded by the other half.
+            float centerX = metrics[i].ink.isEmpty
+                ? x + unit
+                : x + metrics[i].strokeExtent - metrics[i].ink.minimum.x;
+
+            std::vector<Primitive> glyph;
+            for (Primitive primitive :
+                 word[i].primitives(style, Vector(0, 0), runStyle.size)) {
+                if (primitive.settings == "draw=none") {
+                    continue;
+                }
+                if (primitive.settings == strokeSettings) {
+                    primitive.settings = sharedSettings;
+                }
+                glyph.push_back(primitive);
+            }
+            painter->glyph(Vector(centerX, y), glyph);
+
+            x += getAdvance(metrics[i]);
+            if (i + 1 < word.size()) {
+                x += unit * runStyle.letterSpacing;
+            }
+        }
+    }
+}
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numbers>
+#include <queue>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "check.hpp"
+#include "similar.hpp"
+
+/* Maximum length of a segment strokes are split into, in symbol units. */
+static const float SEGMENT_LENGTH = 0.05f;
+
+/* Number of segments a curve is split into before segment splitting. */
+static const unsigned CURVE_STEPS = 16;
+
+/* Spread the weight bilinearly over the grid cells around the point. */
+static void addCoverage(FeatureVector& vector, Vector point, float weight) {
+
+    // Symbol square [-1, 1] × [-1, 1] mapped to cell centers.
+    float x = (point.x + 1) / 2 * COVERAGE_GRID_SIZE - 0.5f;
+    float y = (point.y + 1) / 2 * COVERAGE_GRID_SIZE - 0.5f;
+    float maximum = COVERAGE_GRID_SIZE - 1;
+    x = std::clamp(x, 0.0f, maximum);
+    y = std::clamp(y, 0.0f, maximum);
+
+    unsigned column = std::min<unsigned>(x, COVERAGE_GRID_SIZE - 2);
+    unsigned row = std::min<unsigned>(y, COVERAGE_GRID_SIZE - 2);
+    float dx = x - column;
+    float dy = y - row;
+
+    float* grid = vector.data();
+    grid[row * COVERAGE_GRID_SIZE + column] += weight * (1 - dx) * (1 - dy);
+    grid[row * COVERAGE_GRID_SIZE + column + 1] += weight * dx * (1 - dy);
+    grid[(row + 1) * COVERAGE_GRID_SIZE + column] += weight * (1 - dx) * dy;
+    grid[(row + 1) * COVERAGE_GRID_SIZE + column + 1] += weight * dx * dy;
+}
+
+/* Add the straight stroke split into short segments, return its length. */
+static float addSegment(FeatureVector& vector, Vector point1, Vector point2) {
+
+    Vector difference = point2 - point1;
+    float length = std::hypot(difference.x, difference.y);
+    if (length == 0) {
+        return 0;
+    }
+    unsigned steps = std::max(1.0f, std::ceil(length / SEGMENT_LENGTH));
+    for (unsigned i = 0; i < steps; i++) {
+        addCoverage(
+            vector, point1 + difference * ((i + 0.5f) / steps), length / steps);
+    }
+
+    // Orientation doesn't depend on the stroke direction.
+    float angle = std::atan2(difference.y, difference.x);
+    if (angle < 0) {
+        angle += std::numbers::pi_v<float>;
+    }
+    unsigned bin = angle / std::numbers::pi_v<float> * ORIENTATION_BIN_COUNT;
+    vector[COVERAGE_GRID_SIZE * COVERAGE_GRID_SIZE
+           + std::min(bin, ORIENTATION_BIN_COUNT - 1)]
+        += length;
+
+    return length;
+}
+
+FeatureVector getFeatureVector(const Symbol& symbol) {
+
+    FeatureVector vector {};
+    float length = 0;
+    SymbolStyle style((std::vector<std::string>()));
+
+    for (const Primitive& primitive :
+         symbol.primitives(style, Vector(0, 0), 1.0f)) {
+
+        if (primitive.settings == "draw=none") {
+            continue;
+        }
+        const Vector* points = primitive.points;
+        if (primitive.type == PrimitiveType::Line) {
+            length += addSegment(vector, points[0], points[1]);
+        } else if (primitive.type == PrimitiveType::Curve) {
+            Vector previous = points[0];
+            for (unsigned i = 1; i <= CURVE_STEPS; i++) {
+                float t = static_cast<float>(i) / CURVE_STEPS;
+                float s = 1 - t;
+                Vector point = points[0] * (s * s * s)
+                    + points[1] * (3 * s * s * t) + points[2] * (3 * s * t * t)
+                    + points[3] * (t * t * t);
+                length += addSegment(vector, previous, point);
+                previous = point;
+            }
+        }
+    }
+    if (length > 0) {
+        for (float& value : vector) {
+            value /= length;
+        }
+    }
+    return vector;
+}
+
+float getDistance(const float* vector1, const float* vector2) {
+
+    unsigned i = 0;
+    float distance = 0;
+
+#ifdef __SSE2__
+    __m128 sum = _mm_setzero_ps();
+    for (; i + 4 <= FEATURE_SIZE; i += 4) {
+        __m128 difference = _mm_sub_ps(
+            _mm_loadu_ps(vector1 + i), _mm_loadu_ps(vector2 + i));
+        sum = _mm_add_ps(sum, _mm_mul_ps(difference, difference));
+    }
+    // Horizontal sum of the 4 lanes.
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+    distance = _mm_cvtss_f32(sum);
+#endif
+
+    for (; i < FEATURE_SIZE; i++) {
+        float difference = vector1[i] - vector2[i];
+        distance += difference * difference;
+    }
+    return distance;
+}
+
+void SimilarityIndex::add(
+    const std::string& name, const FeatureVector& vector) {
+    names.push_back(name);
+    vectors.insert(vectors.end(), vector.begin(), vector.end());
+}
+
+size_t SimilarityIndex::size() const {
+    return names.size();
+}
+
+const std::string& SimilarityIndex::getName(unsigned index) const {
+    return names[index];
+}
+
+std::vector<Neighbor>
+SimilarityIndex::findNearest(const FeatureVector& vector, unsigned k) const {
+
+    std::vector<Neighbor> neighbors;
+    for (unsigned i = 0; i < names.size(); i++) {
+        neighbors.push_back(
+            {i, getDistance(vector.data(), vectors.data() + i * FEATURE_SIZE)});
+    }
+    k = std::min<size_t>(k, neighbors.size());
+    std::partial_sort(
+        neighbors.begin(),
+        neighbors.begin() + k,
+        neighbors.end(),
+        [](const Neighbor& neighbor1, const Neighbor& neighbor2) {
+            return neighbor1.distance < neighbor2.distance;
+        });
+    neighbors.resize(k);
+    return neighbors;
+}
+
+std::vector<SimilarPair>
+SimilarityIndex::findClosestPairs(unsigned count) const {
+
+    // The farthest of the closest pairs found so far is on the top.
+    auto isCloser = [](const SimilarPair& pair1, const SimilarPair& pair2) {
+        return pair1.distance < pair2.distance;
+    };
+    std::priority_queue<
+        SimilarPair,
+        std::vector<SimilarPair>,
+        decltype(isCloser)>
+        closest(isCloser);
+
+    for (unsigned i = 0; i < names.size(); i++) {
+        const float* vector1 = vectors.data() + i * FEATURE_SIZE;
+        for (unsigned j = i + 1; j < names.size(); j++) {
+            float distance
+                = getDistance(vector1, vectors.data() + j * FEATURE_SIZE);
+            if (closest.size() < count) {
+                closest.push({i, j, distance});
+            } else if (count > 0 and distance < closest.top().distance) {
+                closest.pop();
+                closest.push({i, j, distance});
+            }
+        }
+    }
+    std::vector<SimilarPair> pairs;
+    while (not closest.empty()) {
+        pairs.push_back(closest.top());
+        closest.pop();
+    }
+    std::reverse(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+// Glyph groups.
+
+GlyphGroups::GlyphGroups(
+    const std::vector<std::string>& combinations,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    const IpaSymbols& ipaSymbols)
+    : combinationCount(combinations.size()) {
+
+    std::map<FeatureVector, unsigned> vectorToGroup;
+    std::vector<FeatureVector> groupVectors;
+    std::vector<std::string> groupNames;
+
+    for (const std::string& parameters : combinations) {
+        Glyph glyph;
+        glyph.parameters = parameters;
+        glyph.ipaSymbol = ipaSymbols.findSymbol(sortParameters(parameters));
+        FeatureVector vector
+            = getFeatureVector(Symbol(getDescriptors(parameters, graphs)));
+
+        auto [it, isNew] = vectorToGroup.try_emplace(vector, groupNames.size());
+        if (isNew) {
+            groupVectors.push_back(vector);
+            groupNames.push_back(getGlyphName(glyph));
+        } else {
+            groupNames[it->second] += " = " + getGlyphName(glyph);
+        }
+        keyToGroup[sortParameters(parameters)] = it->second;
+    }
+    for (unsigned i = 0; i < groupNames.size(); i++) {
+        index.add(groupNames[i], groupVectors[i]);
+    }
+}
+
+const SimilarityIndex& GlyphGroups::getIndex() const {
+    return index;
+}
+
+size_t GlyphGroups::getCombinationCount() const {
+    return combinationCount;
+}
+
+std::string GlyphGroups::getName(const std::string& parameters) const {
+    auto group = keyToGroup.find(sortParameters(parameters));
+    return group == keyToGroup.end() ? parameters
+                                     : index.getName(group->second);
+}
+
+std::vector<Neighbor> GlyphGroups::findNearest(
+    const std::string& parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    unsigned k) const {
+
+    // The group of the parameters is the nearest one, so one more neighbor
+    // is requested and the group is skipped.
+    auto group = keyToGroup.find(sortParameters(parameters));
+    bool isGrouped = group != keyToGroup.end();
+
+    FeatureVector vector
+        = getFeatureVector(Symbol(getDescriptors(parameters, graphs)));
+    std::vector<Neighbor> neighbors
+        = index.findNearest(vector, isGrouped ? k + 1 : k);
+    if (isGrouped) {
+        std::erase_if(neighbors, [&](const Neighbor& neighbor) {
+            return neighbor.index == group->second;
+        });
+        neighbors.resize(std::min<size_t>(neighbors.size(), k));
+    }
+    return neighbors;
+}
@@ -1,18 +1,22 @@
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "filter.hpp"
 #include "geometry.hpp"
 #include "symbol.hpp"
 #include "util.hpp"
 #include "visual.hpp"
 
-float DOUBLE_SIZE = 0.5;
-float CURVE_SIZE = 0.5;
-float CURVATURE = 0.6;
+// Sizes in fixed-point units: `GRID_SCALE` is 1.
+const int DOUBLE_SIZE = GRID_SCALE / 2;
+const int CURVE_SIZE = GRID_SCALE / 2;
+const int CURVATURE = GRID_SCALE * 3 / 5;
+const int DOUBLE_CENTER_SHIFT = GRID_SCALE * 2 / 5;
 
 std::string sortParameters(std::string parameters) {
 
@@ -27,69 +31,90 @@ std::string sortParameters(std::string parameters) {
     return result.str();
 }
 
-Vector Element::getNorm() {
-    return indirectedNorm * position;
+GridVector Element::getDirection() const {
+    switch (direction) {
+    case ElementDirection::Horizontal:
+        return GridVector(GRID_SCALE, 0);
+    case ElementDirection::Vertical:
+        return GridVector(0, GRID_SCALE);
+    case ElementDirection::Slash:
+        return GridVector(GRID_SCALE, GRID_SCALE);
+    case ElementDirection::Backslash:
+        return GridVector(GRID_SCALE, -GRID_SCALE);
+    default:
+        return GridVector();
+    }
 }
 
-Vector Element::getPoint1() {
-    return getNorm() + direction * pointOffset1;
+GridVector Element::getIndirectedNorm() const {
+    switch (direction) {
+    case ElementDirection::Horizontal:
+        return GridVector(0, GRID_SCALE);
+    case ElementDirection::Vertical:
+        return GridVector(GRID_SCALE, 0);
+    default:
+        // Diagonal lines are shifted along their direction.
+        return getDirection();
+    }
 }
 
-Vector Element::getPoint2() {
-    return getNorm() + direction * pointOffset2;
+GridVector Element::getNorm() const {
+    return getIndirectedNorm() * (position * GRID_SCALE);
 }
 
-void Element::add(ElementDescriptor elementDescriptor) {
+GridVector Element::getPoint1() const {
+    return getNorm() + getDirection() * (pointOffset1 * GRID_SCALE);
+}
 
-    elementDescriptors.push_back(elementDescriptor);
+GridVector Element::getPoint2() const {
+    return getNorm() + getDirection() * (pointOffset2 * GRID_SCALE);
+}
+
+void Element::add(ElementDescriptor elementDescriptor) {
 
     switch (elementDescriptor) {
     case ElementDescriptor::Horizontal:
-        indirectedNorm = Vector(0.0f, 1.0f);
-        direction = Vector(1.0f, 0.0f);
+        direction = ElementDirection::Horizontal;
         break;
     case ElementDescriptor::Vertical:
-        indirectedNorm = Vector(1.0f, 0.0f);
-        direction = Vector(0.0f, 1.0f);
+        direction = ElementDirection::Vertical;
         break;
     case ElementDescriptor::Slash:
-        indirectedNorm = Vector(1.0f, 1.0f);
-        direction = Vector(1.0f, 1.0f);
+        direction = ElementDirection::Slash;
         isDiagonal = true;
         break;
     case ElementDescriptor::Backslash:
-        indirectedNorm = Vector(1.0f, -1.0f);
-        direction = Vector(1.0f, -1.0f);
+        direction = ElementDirection::Backslash;
         isDiagonal = true;
         break;
     case ElementDescriptor::Center:
         position = 0;
         break;
     case ElementDescriptor::Right:
-        if (direction == Vector(0.0f, 1.0f)) { // Vertical.
+        if (direction == ElementDirection::Vertical) {
             position = 1;
-        } else if (direction == Vector(1.0f, 0.0f)) { // Horizontal.
+        } else if (direction == ElementDirection::Horizontal) {
             pointOffset1 = 0;
         }
         break;
     case ElementDescriptor::Left:
-        if (direction == Vector(0.0f, 1.0f)) { // Vertical.
+        if (direction == ElementDirection::Vertical) {
             position = -1;
-        } else if (direction == Vector(1.0f, 0.0f)) { // Horizontal.
+        } else if (direction == ElementDirection::Horizontal) {
             pointOffset2 = 0;
         }
         break;
     case ElementDescriptor::Top:
-        if (direction == Vector(1.0f, 0.0f)) { // Horizontal.
+        if (direction == ElementDirection::Horizontal) {
             position = 1;
-        } else if (direction == Vector(0.0f, 1.0f)) { // Vertical.
+        } else if (direction == ElementDirection::Vertical) {
             pointOffset1 = 0; // TODO: recheck.
         }
         break;
     case ElementDescriptor::Bottom:
-        if (direction == Vector(1.0f, 0.0f)) { // Horizontal.
+        if (direction == ElementDirection::Horizontal) {
             position = -1;
-        } else if (direction == Vector(0.0f, 1.0f)) { // Vertical.
+        } else if (direction == ElementDirection::Vertical) {
             pointOffset2 = 0; // TODO: recheck.
         }
         break;
@@ -115,26 +140,11 @@ void Element::add(ElementDescriptor elementDescriptor) {
     }
 }
 
-inline float parseFloat(std::string floatValue) {
-    return std::stof(floatValue);
-}
-
 inline Vector parseVector(std::string vectorValue) {
     std::vector<std::string> coordinates = split(vectorValue, ',');
     return Vector(parseFloat(coordinates[0]), parseFloat(coordinates[1]));
 }
 
-inline bool parseBool(std::string boolValue) {
-    if (boolValue == "+") {
-        return true;
-    }
-    if (boolValue == "-") {
-        return false;
-    }
-    throw std::invalid_argument(
-        "Unknown Boolean value: `" + boolValue + "`, should be `+` or `-`.");
-}
-
 SymbolStyle::SymbolStyle(std::vector<std::string> descriptions) {
     for (std::string description : descriptions) {
 
@@ -157,63 +167,120 @@ SymbolStyle::SymbolStyle(std::vector<std::string> descriptions) {
             shiftByCurved = parseBool(value);
         } else if (key == "cd") {
             curveDiagonal = parseBool(value);
+        } else if (key == "sk") {
+            slant = parseFloat(value);
         }
     }
 }
 
-void Element::draw(
-    Painter* painter,
+// Primitives are created outside of coroutines: GCC 12 fails to compile
+// braced array initializers in coroutine bodies.
+
+static Primitive createLine(
+    Vector point1, Vector point2, std::string settings) {
+    return {PrimitiveType::Line, {point1, point2}, 2, settings, ""};
+}
+
+static Primitive createRectangle(
+    Vector point1, Vector point2, std::string settings) {
+    return {PrimitiveType::Rectangle, {point1, point2}, 2, settings, ""};
+}
+
+static Primitive createCurve(
+    Vector point1,
+    Vector point2,
+    Vector point3,
+    Vector point4,
+    std::string settings) {
+    return {
+        PrimitiveType::Curve,
+        {point1, point2, point3, point4},
+        4,
+        settings,
+        ""};
+}
+
+Transform SymbolStyle::getTransform(Vector center, float size) const {
+    return Transform::translation(center + position)
+        * Transform::scale(size * zoom) * Transform::skew(slant);
+}
+
+Transform
+SymbolStyle::getTransform(Vector center, float size, unsigned point) const {
+
+    Transform transform = getTransform(center, size);
+    if (not isHandwritten) {
+        return transform;
+    }
+    // Shifts are in grid units, scales are applied after them.
+    static const GridVector shifts[4] = {
+        GridVector(50, 100),
+        GridVector(50, -100),
+        GridVector(-50, 100),
+        GridVector(50, 100)};
+    static const float scales[4] = {0.85f, 0.70f, 0.75f, 0.80f};
+
+    return transform * Transform::scale(scales[point])
+        * Transform::translation(shifts[point].toVector());
+}
+
+std::string SymbolStyle::getStrokeSettings() const {
+    return "line cap=round, line width=" + std::to_string(lineWidth);
+}
+
+Generator<Primitive> Element::primitives(
     SymbolStyle style,
-    Vector center,
-    float size,
-    Vector step,
-    std::vector<Element> elements) {
+    GridVector step,
+    std::span<const Element> elements) const {
 
-    Vector norm = getNorm();
+    GridVector norm = getNorm();
+    GridVector direction = getDirection();
+    int pointOffset1 = this->pointOffset1 * GRID_SCALE;
+    int pointOffset2 = this->pointOffset2 * GRID_SCALE;
 
     // Apply style.
-    std::string tikzStyle
-        = "line cap=round, line width=" + std::to_string(style.lineWidth);
-    size *= style.zoom;
-    center = center + style.position;
+    std::string tikzStyle = style.getStrokeSettings();
+
+    // Convert fixed-point grid coordinates to the symbol space.
+    auto toPlane = [](GridVector point) { return point.toVector(); };
+    auto curve = [&](
+                     GridVector p1,
+                     GridVector p2,
+                     GridVector p3,
+                     GridVector p4) {
+        return createCurve(
+            toPlane(p1), toPlane(p2), toPlane(p3), toPlane(p4), tikzStyle);
+    };
 
     if (isCurved) {
 
-        float curveDirection = isInwards ? 1 : -1;
+        int curveDirection = isInwards ? GRID_SCALE : -GRID_SCALE;
         if (isInwards) {
             step = step + norm * -CURVE_SIZE;
         }
 
         // Line.
-        Vector start = step + direction * (1 - CURVE_SIZE);
-        Vector end = step - direction * (1 - CURVE_SIZE);
-        painter->line(center + start * size, center + end * size, tikzStyle);
+        GridVector start = step + direction * (GRID_SCALE - CURVE_SIZE);
+        GridVector end = step - direction * (GRID_SCALE - CURVE_SIZE);
+        co_yield createLine(toPlane(start), toPlane(end), tikzStyle);
 
         // Curve.
-        Vector p = step + direction;
-        Vector p1 = p - direction * CURVE_SIZE;
-        Vector p2 = p - direction * CURVE_SIZE * (1 - CURVATURE);
-        Vector p3 = p + (norm * CURVE_SIZE * (1 - CURVATURE)) * curveDirection;
-        Vector p4 = p + (norm * CURVE_SIZE) * curveDirection;
-        painter->curve(
-            center + p1 * size,
-            center + p2 * size,
-            center + p3 * size,
-            center + p4 * size,
-            tikzStyle);
+        GridVector p = step + direction;
+        GridVector p1 = p - direction * CURVE_SIZE;
+        GridVector p2 = p - direction * CURVE_SIZE * (GRID_SCALE - CURVATURE);
+        GridVector p3 = p
+            + (norm * CURVE_SIZE * (GRID_SCALE - CURVATURE)) * curveDirection;
+        GridVector p4 = p + (norm * CURVE_SIZE) * curveDirection;
+        co_yield curve(p1, p2, p3, p4);
 
         // Curve.
         p = step - direction;
         p1 = p + direction * CURVE_SIZE;
-        p2 = p + direction * CURVE_SIZE * (1 - CURVATURE);
-        p3 = p + (norm * CURVE_SIZE * (1 - CURVATURE)) * curveDirection;
+        p2 = p + direction * CURVE_SIZE * (GRID_SCALE - CURVATURE);
+        p3 = p
+            + (norm * CURVE_SIZE * (GRID_SCALE - CURVATURE)) * curveDirection;
         p4 = p + (norm * CURVE_SIZE) * curveDirection;
-        painter->curve(
-            center + p1 * size,
-            center + p2 * size,
-            center + p3 * size,
-            center + p4 * size,
-            tikzStyle);
+        co_yield curve(p1, p2, p3, p4);
 
     } else if (isPointed) {
 
@@ -221,18 +288,18 @@ void Element::draw(
 
     } else { // Horizontal, vertical, or diagonal line.
 
-        Vector p1 = step + direction * pointOffset1; // Point 1.
-        Vector p2 = step + direction * pointOffset1; // Curve point 1.
-        Vector p3 = step + direction * pointOffset2; // Curve point 2.
-        Vector p4 = step + direction * pointOffset2; // Point 2.
+        GridVector p1 = step + direction * pointOffset1; // Point 1.
+        GridVector p2 = step + direction * pointOffset1; // Curve point 1.
+        GridVector p3 = step + direction * pointOffset2; // Curve point 2.
+        GridVector p4 = step + direction * pointOffset2; // Point 2.
 
         // Check other elements.
         // TODO: ignore the element itself.
-        for (Element element : elements) {
+        for (const Element& element : elements) {
 
             // Other element is double.
             if (element.isDouble
-                and getNorm().isGridParallelTo(element.direction)
+                and getNorm().isGridParallelTo(element.getDirection())
                 and element.position != 0) {
 
                 // Shift point.
@@ -263,9 +330,10 @@ void Element::draw(
 
                 // Shift point if the element is no the edge, orthogonal to the
                 // curved element, and the curved element is curved inwards.
-                if ((step.x == 1 or step.x == -1 or step.y == 1 or step.y == -1)
+                if ((std::abs(step.x) == GRID_SCALE
+                     or std::abs(step.y) == GRID_SCALE)
                     and style.shiftByCurved
-                    and getNorm().isGridParallelTo(element.direction)
+                    and getNorm().isGridParallelTo(element.getDirection())
                     and not element.isInwards) {
                     // Shift point.
                     if (element.getNorm().isGridCodirectedTo(direction)) {
@@ -287,14 +355,14 @@ void Element::draw(
                             p2 = p2 + element.getNorm() * -CURVE_SIZE;
                         }
                         if (style.curveDiagonal) {
-                            p2 = p2 + element.getNorm() * -CURVE_SIZE * 2;
+                            p2 = p2 + element.getNorm() * (-2 * CURVE_SIZE);
                         }
                     }
                     if (element.getPoint1() == p4
                         or element.getPoint2() == p4) {
 
                         if (style.curveDiagonal) {
-                            p3 = p3 + element.getNorm() * -CURVE_SIZE * 2;
+                            p3 = p3 + element.getNorm() * (-2 * CURVE_SIZE);
                         }
                         if (not element.isInwards and style.shiftByCurved) {
                             p4 = p4 + element.getNorm() * -CURVE_SIZE;
@@ -304,48 +372,27 @@ void Element::draw(
                 }
             }
         }
-        if (style.isHandwritten) {
-            painter->curve(
-                center + (p1 + Vector(0.05, 0.10)) * size * 0.85,
-                center + (p2 + Vector(0.05, -0.10)) * size * 0.70,
-                center + (p3 + Vector(-0.05, 0.10)) * size * 0.75,
-                center + (p4 + Vector(0.05, 0.10)) * size * 0.80,
-                tikzStyle);
-        } else {
-            painter->curve(
-                center + p1 * size,
-                center + p2 * size,
-                center + p3 * size,
-                center + p4 * size,
-                tikzStyle);
-        }
+        co_yield curve(p1, p2, p3, p4);
     }
 }
 
-/*
- * Draw symbol element.
- */
-void Element::draw(
-    Painter* painter,
-    SymbolStyle style,
-    Vector center,
-    float size,
-    std::vector<Element> elements) {
+Generator<Primitive> Element::primitives(
+    SymbolStyle style, std::span<const Element> elements) const {
 
+    std::vector<GridVector> steps;
     if (isDouble and position == 0) {
-        draw(painter, style, center, size, indirectedNorm * 0.4f, elements);
-        draw(
-            painter, style, center, size, indirectedNorm * -1 * 0.4f, elements);
+        steps = {
+            getIndirectedNorm() * DOUBLE_CENTER_SHIFT,
+            getIndirectedNorm() * -DOUBLE_CENTER_SHIFT};
     } else {
-        draw(painter, style, center, size, getNorm() * 1.0f, elements);
+        steps = {getNorm()};
         if (isDouble) {
-            draw(
-                painter,
-                style,
-                center,
-                size,
-                getNorm() * (1 - DOUBLE_SIZE),
-                elements);
+            steps.push_back(getNorm() * (GRID_SCALE - DOUBLE_SIZE));
+        }
+    }
+    for (GridVector step : steps) {
+        for (const Primitive& primitive : primitives(style, step, elements)) {
+            co_yield primitive;
         }
     }
 }
@@ -369,25 +416,169 @@ void Symbol::add(Element element) {
     elements.push_back(element);
 }
 
-void Symbol::draw(
-    Painter* painter, SymbolStyle style, Vector center, float size) {
+/*
+ * Map points of the primitives from the symbol space to the plane.
+ *
+ * Points are gathered into one buffer grouped by their index in the primitive,
+ * every group is transformed in one pass (see `SymbolStyle::getTransform`),
+ * and points are written back.
+ */
+static void mapToPlane(
+    std::span<Primitive> primitives,
+    const SymbolStyle& style,
+    Vector center,
+    float size) {
+
+    std::vector<Vector> points;
+    points.reserve(4 * primitives.size());
+    size_t starts[5];
+
+    for (unsigned i = 0; i < 4; i++) {
+        starts[i] = points.size();
+        for (const Primitive& primitive : primitives) {
+            if (i < primitive.pointCount) {
+                points.push_back(primitive.points[i]);
+            }
+        }
+    }
+    starts[4] = points.size();
+
+    for (unsigned i = 0; i < 4; i++) {
+        style.getTransform(center, size, i)
+            .apply(points.data() + starts[i], starts[i + 1] - starts[i]);
+    }
+    const Vector* point = points.data();
+    for (unsigned i = 0; i < 4; i++) {
+        for (Primitive& primitive : primitives) {
+            if (i < primitive.pointCount) {
+                primitive.points[i] = *point++;
+            }
+        }
+    }
+}
+
+/* Transforms of the points of a primitive, see `SymbolStyle::getTransform`. */
+struct PointTransforms {
+    Transform transforms[4];
+
+    PointTransforms(const SymbolStyle& style, Vector center, float size) {
+        for (unsigned i = 0; i < 4; i++) {
+            transforms[i] = style.getTransform(center, size, i);
+        }
+    }
+
+    void apply(Primitive& primitive) const {
+        for (unsigned i = 0; i < primitive.pointCount; i++) {
+            primitive.points[i] = transforms[i].apply(primitive.points[i]);
+        }
+    }
+};
+
+Generator<Primitive> Symbol::primitives(
+    SymbolStyle style, Vector center, float size) const {
+
+    Transform transform = style.getTransform(center, size);
+    PointTransforms pointTransforms(style, center, size);
 
     if (style.useBackground) {
-        painter->rectangle(
-            Vector(-1, -1) * size * style.zoom + style.position,
-            Vector(1, 1) * size * style.zoom + style.position,
+        co_yield createRectangle(
+            transform.apply(Vector(-1, -1)),
+            transform.apply(Vector(1, 1)),
             "draw, densely dotted");
     }
-
-    for (Element element : elements) {
-        element.draw(painter, style, center, size, elements);
+    for (const Element& element : elements) {
+        for (Primitive primitive : element.primitives(style, elements)) {
+            pointTransforms.apply(primitive);
+            co_yield primitive;
+        }
     }
-    painter->line(
-        Vector(0, 0) + style.position,
-        Vector(0, 1.3 * size * style.zoom) + style.position,
+    co_yield createLine(
+        transform.apply(Vector(0, 0)),
+        transform.apply(Vector(0, 1.3f)),
         "draw=none");
 }
 
+size_t Symbol::getElementCount() const {
+    return elements.size();
+}
+
+Generator<Primitive> Symbol::elementPrimitives(
+    unsigned index, SymbolStyle style, Vector center, float size) const {
+
+    PointTransforms pointTransforms(style, center, size);
+
+    for (Primitive primitive : elements[index].primitives(style, elements)) {
+        pointTransforms.apply(primitive);
+        co_yield primitive;
+    }
+}
+
+SymbolMetrics Symbol::getMetrics(SymbolStyle style, float size) const {
+
+    SymbolMetrics metrics;
+
+    std::vector<Primitive> primitives;
+    for (const Element& element : elements) {
+        for (const Primitive& primitive : element.primitives(style, elements)) {
+            primitives.push_back(primitive);
+        }
+    }
+    mapToPlane(primitives, style, Vector(0, 0), size);
+
+    for (const Primitive& primitive : primitives) {
+        if (primitive.type == PrimitiveType::Curve) {
+            metrics.ink.addCurve(
+                primitive.points[0],
+                primitive.points[1],
+                primitive.points[2],
+                primitive.points[3]);
+        } else {
+            for (unsigned i = 0; i < primitive.pointCount; i++) {
+                metrics.ink.add(primitive.points[i]);
+            }
+        }
+    }
+    // Line caps are round, so strokes extend equally in all directions.
+    metrics.strokeExtent = style.lineWidth / 2 / POINTS_PER_CM;
+    metrics.ink.pad(metrics.strokeExtent);
+    if (not metrics.ink.isEmpty) {
+        metrics.advance = metrics.ink.getWidth() + 2 * metrics.strokeExtent;
+    }
+    return metrics;
+}
+
+template <PainterPolicy P>
+void Symbol::draw(
+    P& painter, SymbolStyle style, Vector center, float size) const {
+
+    // Primitives are drawn relative to the center, so that the painter can
+    // reuse the same glyph in different places. The glyph is drawn whole, so
+    // points of all elements are transformed in one pass; the primitives are
+    // the same as of `primitives`.
+    Transform transform = style.getTransform(Vector(0, 0), size);
+    std::vector<Primitive> glyph;
+
+    if (style.useBackground) {
+        glyph.push_back(createRectangle(
+            transform.apply(Vector(-1, -1)),
+            transform.apply(Vector(1, 1)),
+            "draw, densely dotted"));
+    }
+    size_t start = glyph.size();
+    for (const Element& element : elements) {
+        for (const Primitive& primitive : element.primitives(style, elements)) {
+            glyph.push_back(primitive);
+        }
+    }
+    mapToPlane(
+        std::span(glyph).subspan(start), style, Vector(0, 0), size);
+    glyph.push_back(createLine(
+        transform.apply(Vector(0, 0)),
+        transform.apply(Vector(0, 1.3f)),
+        "draw=none"));
+    painter.glyph(center, glyph);
+}
+
 // Convert graphical element text representation into element descriptor.
 ElementDescriptor getElementDescriptor(char elementRepr) {
 
@@ -415,6 +606,9 @@ parseGraphs(const std::string& path) {
 
     while (std::getline(inFile, line)) {
         std::vector<std::string> row = split(line, ' ');
+        if (row.empty()) {
+            continue;
+        }
         std::string name = row[0];
         row.erase(row.begin());
         graphs[name] = row;
@@ -422,6 +616,53 @@ parseGraphs(const std::string& path) {
     return graphs;
 }
 
+IpaSymbols* parseTables(const std::string& path) {
+
+    // Symbols are owned here until the whole file is parsed.
+    auto ipaSymbols = std::make_unique<IpaSymbols>();
+
+    std::ifstream inFile(path);
+
+    if (not inFile.is_open()) {
+        throw std::invalid_argument("Could not open the file " + path + ".");
+    }
+
+    std::string line;
+    std::getline(inFile, line);
+    std::vector<std::string> columns = split(line, ' ');
+    ipaSymbols->columns = columns;
+    bool isMainTable = true;
+
+    while (std::getline(inFile, line)) {
+
+        if (line.empty()) {
+            std::getline(inFile, line);
+            columns = split(line, ' ');
+            isMainTable = false;
+            continue;
+        }
+        std::vector<std::string> parts = split(line, ' ');
+        // A row of a partially written file may be shorter or longer than
+        // the header.
+        if (parts.size() != columns.size() + 1) {
+            throw std::invalid_argument(
+                "Row `" + line + "` of " + path + " should have "
+                + std::to_string(columns.size()) + " cells.");
+        }
+        std::string row = parts[0];
+        if (isMainTable) {
+            ipaSymbols->rows.push_back(row);
+        }
+
+        for (unsigned i = 1; i < parts.size(); i++) {
+
+            std::string parameters = columns[i - 1] + ';' + row;
+            ipaSymbols->add(parameters, parts[i]);
+        }
+    }
+    return ipaSymbols.release();
+}
+
 std::pair<Symbol, SymbolStyle>
 parseSymbolParameters(std::vector<std::string> parameters) {
 
@@ -440,18 +681,34 @@ parseSymbolParameters(std::vector<std::string> parameters) {
     return pair;
 }
 
+bool hasIpaSymbol(std::string ipaSymbol) {
+    return ipaSymbol != "-" and ipaSymbol != "=" and ipaSymbol != " ";
+}
+
+/* Metrics of the table cell symbol relative to the symbol center. */
+static SymbolMetrics getCellSymbolMetrics(std::vector<std::string> reprs) {
+    std::pair<Symbol, SymbolStyle> pair = parseSymbolParameters(reprs);
+    return pair.first.getMetrics(pair.second, CELL_SYMBOL_SIZE);
+}
+
+/* Draw IPA symbol of a table cell. */
+template <PainterPolicy P>
+static void
+drawIpaSymbol(P& painter, const std::string& ipaSymbol, Vector center) {
+    painter.text(center - Vector(0, 0), "\\doulos{" + ipaSymbol + "}", "");
+}
+
+template <PainterPolicy P>
 void drawTikz(
-    Painter* painter,
-    std::string ipaSymbol,
-    std::vector<std::string> reprs,
+    P& painter,
+    const std::string& ipaSymbol,
+    const std::vector<std::string>& reprs,
     Vector center) {
 
-    bool hasIpaSymbol
-        = ipaSymbol != "-" and ipaSymbol != "=" and ipaSymbol != " ";
     bool isImpossible = ipaSymbol == "=";
 
-    if (hasIpaSymbol) {
-        painter->text(center - Vector(0, 0), "\\doulos{" + ipaSymbol + "}", "");
+    if (hasIpaSymbol(ipaSymbol)) {
+        drawIpaSymbol(painter, ipaSymbol, center);
     } else {
         if (isImpossible) { }
         return;
@@ -460,7 +717,11 @@ void drawTikz(
     std::pair<Symbol, SymbolStyle> pair = parseSymbolParameters(reprs);
     Symbol symbol = pair.first;
     SymbolStyle style = pair.second;
-    symbol.draw(painter, style, center + Vector(0.5, 0), 0.1f);
+    symbol.draw(
+        painter,
+        style,
+        center + Vector(CELL_SYMBOL_SHIFT, 0),
+        CELL_SYMBOL_SIZE);
 }
 
 void IpaSymbols::add(std::string parameters, std::string ipaSymbol) {
@@ -468,95 +729,262 @@ void IpaSymbols::add(std::string parameters, std::string ipaSymbol) {
     symbols[key] = ipaSymbol;
 }
 
-std::string IpaSymbols::findSymbol(std::string key) {
-    if (symbols.contains(key)) {
-        return symbols[key];
+std::string IpaSymbols::findSymbol(std::string key) const {
+    auto it = symbols.find(key);
+    if (it != symbols.end()) {
+        return it->second;
     }
     return " ";
 }
 
+const std::unordered_map<std::string, std::string>&
+IpaSymbols::getSymbols() const {
+    return symbols;
+}
+
+std::vector<std::string> getDescriptors(
+    std::string parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    std::vector<std::string> descriptors;
+
+    for (std::string parameter : split(parameters, ';')) {
+        if (graphs.contains(parameter)) {
+            for (std::string descriptor : graphs.at(parameter)) {
+                if (descriptor != ".") {
+                    descriptors.push_back(descriptor);
+                }
+            }
+        } else {
+            std::cerr << "Unknown parameter <" << parameter << ">" << std::endl;
+        }
+    }
+    return descriptors;
+}
+
 std::string parametersToTex(std::string parameters) {
     parameters = std::regex_replace(parameters, std::regex("_"), " ");
     parameters = std::regex_replace(parameters, std::regex(";"), ", ");
     return parameters;
 }
 
-void drawTable(
-    Painter* painter,
-    std::vector<std::string> columns,
-    std::vector<std::string> rows,
-    std::vector<std::string> filter,
+CellGlyph createCellGlyph(
+    const std::string& parameters,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs) {
+
+    CellGlyph glyph;
+    glyph.descriptors = getDescriptors(parameters, graphs);
+
+    // Primitives are relative to the center, like in `Symbol::draw`.
+    std::pair<Symbol, SymbolStyle> pair
+        = parseSymbolParameters(glyph.descriptors);
+    glyph.ink = pair.first.getMetrics(pair.second, CELL_SYMBOL_SIZE).ink;
+    for (const Primitive& primitive :
+         pair.first.primitives(pair.second, Vector(0, 0), CELL_SYMBOL_SIZE)) {
+        glyph.primitives.push_back(primitive);
+    }
+    return glyph;
+}
+
+GlyphCache::GlyphCache(std::unordered_map<std::string, CellGlyph> glyphs)
+    : glyphs(std::move(glyphs)) { }
+
+const CellGlyph* GlyphCache::find(const std::string& parameters) const {
+    auto it = glyphs.find(parameters);
+    return it == glyphs.end() ? nullptr : &it->second;
+}
+
+size_t GlyphCache::size() const {
+    return glyphs.size();
+}
+
+TableCells::TableCells(
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const TableFilter& filter,
     IpaSymbols* ipaSymbols,
-    std::unordered_map<std::string, std::vector<std::string>> graphs) {
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    const GlyphCache* cache) {
+
+    // Find symbols of the cells and compile the filter for them.
+    for (unsigned i = 0; i < rows.size(); i++) {
+        for (unsigned j = 0; j < columns.size(); j++) {
+            std::string key = sortParameters(columns[j] + ";" + rows[i]);
+            cellSymbols.push_back(ipaSymbols->findSymbol(key));
+        }
+    }
+    Bitset passing = filter.compile(columns, rows, cellSymbols, graphs);
+
+    for (unsigned cell = 0; cell < cellSymbols.size(); cell++) {
+        std::string parameters = columns[cell % columns.size()] + ";"
+            + rows[cell / columns.size()];
+        std::vector<std::string> descriptors;
+        const CellGlyph* glyph = nullptr;
+
+        if (not passing.test(cell)) {
+            cellSymbols[cell] = " ";
+        } else if (cache and (glyph = cache->find(parameters))) {
+            descriptors = glyph->descriptors;
+        } else {
+            descriptors = getDescriptors(parameters, graphs);
+        }
+        cellDescriptors.push_back(descriptors);
+        cellGlyphs.push_back(glyph);
+    }
+}
 
-    float x = 0.0f;
-    float y = 0.0f;
+TableLayout::TableLayout(
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const TableFilter& filter,
+    IpaSymbols* ipaSymbols,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    const GlyphCache* cache)
+    : TableLayout(
+          columns,
+          rows,
+          TableCells(columns, rows, filter, ipaSymbols, graphs, cache)) { }
+
+TableLayout::TableLayout(
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    TableCells cells)
+    : TableCells(std::move(cells)) {
 
     float xStep = 1.0f;
     float yStep = 0.5f;
 
+    // Cells are at least `xStep` × `yStep` and grow if their symbols don't
+    // fit.
+    std::vector<float> widths(columns.size(), xStep);
+    heights.assign(rows.size(), yStep);
+
+    for (unsigned i = 0; i < rows.size(); i++) {
+        for (unsigned j = 0; j < columns.size(); j++) {
+            unsigned cell = i * columns.size() + j;
+            if (not hasIpaSymbol(cellSymbols[cell])) {
+                continue;
+            }
+            BoundingBox ink = cellGlyphs[cell]
+                ? cellGlyphs[cell]->ink
+                : getCellSymbolMetrics(cellDescriptors[cell]).ink;
+            if (not ink.isEmpty) {
+                widths[j] = std::max(
+                    widths[j], CELL_SYMBOL_SHIFT + 0.25f + ink.maximum.x);
+                heights[i] = std::max(
+                    heights[i], 2 * std::max(ink.maximum.y, -ink.minimum.y));
+            }
+        }
+    }
+
+    // Coordinates of the cell borders, rows go down from `-0`.
+    xs = {0.0f};
+    for (float width : widths) {
+        xs.push_back(xs.back() + width);
+    }
+    ys = {-0.0f};
+    for (float height : heights) {
+        ys.push_back(ys.back() - height);
+    }
+}
+
+Vector TableLayout::getCellCenter(unsigned row, unsigned column) const {
+    return Vector(xs[column] + 0.25, ys[row] - heights[row] / 2);
+}
+
+template <PainterPolicy P>
+void drawTable(
+    P& painter,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const TableFilter& filter,
+    IpaSymbols* ipaSymbols,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    const GlyphCache* cache) {
+
+    drawTable(
+        painter,
+        columns,
+        rows,
+        TableCells(columns, rows, filter, ipaSymbols, graphs, cache));
+}
+
+template <PainterPolicy P>
+void drawTable(
+    P& painter,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& rows,
+    const TableCells& cells) {
+
+    TableLayout layout(columns, rows, cells);
+    const std::vector<float>& xs = layout.xs;
+    const std::vector<float>& ys = layout.ys;
+    const std::vector<float>& heights = layout.heights;
+
     for (unsigned i = 0; i <= columns.size(); i++) {
-        painter->line(
-            Vector(i * xStep, 0),
-            Vector(i * xStep, rows.size() * -yStep),
-            "draw=black");
+        painter.line(Vector(xs[i], 0), Vector(xs[i], ys.back()), "draw=black");
         if (i < columns.size()) {
-            painter->text(
-                Vector(i * xStep + 0.5, y + 0.3),
+            painter.text(
+                Vector(xs[i] + 0.5, 0.3),
                 parametersToTex(columns[i]),
                 "anchor=west, rotate=30");
         }
     }
     for (unsigned i = 0; i <= rows.size(); i++) {
-        painter->line(
-            Vector(0, i * -yStep),
-            Vector(columns.size() * xStep, i * -yStep),
-            "draw=black");
+        painter.line(Vector(0, ys[i]), Vector(xs.back(), ys[i]), "draw=black");
         if (i < rows.size()) {
-            painter->text(
-                Vector(x - 0.1, i * -yStep - (yStep / 2)),
+            painter.text(
+                Vector(-0.1, ys[i] - heights[i] / 2),
                 parametersToTex(rows[i]),
                 "anchor=east");
         }
     }
 
-    for (std::string row : rows) {
-        for (std::string column : columns) {
-
-            std::string parameters = column + ";" + row;
-            std::vector<std::string> parametersVector = split(parameters, ';');
-            std::string key = sortParameters(parameters);
-            std::string ipaSymbol = ipaSymbols->findSymbol(key);
-
-            if (std::find(filter.begin(), filter.end(), ipaSymbol)
-                == filter.end()) {
-
-                x += xStep;
-                continue;
+    for (unsigned i = 0; i < rows.size(); i++) {
+        for (unsigned j = 0; j < columns.size(); j++) {
+            unsigned cell = i * columns.size() + j;
+            const std::string& ipaSymbol = layout.cellSymbols[cell];
+            Vector center = layout.getCellCenter(i, j);
+
+            if (layout.cellGlyphs[cell] and hasIpaSymbol(ipaSymbol)) {
+                drawIpaSymbol(painter, ipaSymbol, center);
+                painter.glyph(
+                    center + Vector(CELL_SYMBOL_SHIFT, 0),
+                    layout.cellGlyphs[cell]->primitives);
+            } else {
+                drawTikz(
+                    painter, ipaSymbol, layout.cellDescriptors[cell], center);
             }
-
-            std::vector<std::string> descriptors;
-
-            for (std::string parameter : parametersVector) {
-                if (graphs.contains(parameter)) {
-                    for (unsigned k = 0; k < graphs[parameter].size(); k++) {
-                        std::string descriptor = graphs[parameter][k];
-                        if (descriptor != ".") {
-                            descriptors.push_back(graphs[parameter][k]);
-                        }
-                    }
-                } else {
-                    std::cerr << "Unknown parameter <" << parameter << ">"
-                              << std::endl;
-                }
-            }
-            drawTikz(
-                painter, ipaSymbol, descriptors, Vector(x + 0.25, y - 0.25));
-            x += xStep;
         }
-        y -= yStep;
-        x = 0;
     }
-    painter->end();
-    std::cout << painter->getString();
 }
+
+// Drawing code is compiled for every painter, so that calls of a concrete
+// painter are resolved statically.
+#define INSTANTIATE_DRAWING(P) \
+    template void Symbol::draw<P>( \
+        P& painter, SymbolStyle style, Vector center, float size) const; \
+    template void drawTikz<P>( \
+        P& painter, \
+        const std::string& ipaSymbol, \
+        const std::vector<std::string>& reprs, \
+        Vector center); \
+    template void drawTable<P>( \
+        P& painter, \
+        const std::vector<std::string>& columns, \
+        const std::vector<std::string>& rows, \
+        const TableFilter& filter, \
+        IpaSymbols* ipaSymbols, \
+        const std::unordered_map<std::string, std::vector<std::string>>& \
+            graphs, \
+        const GlyphCache* cache); \
+    template void drawTable<P>( \
+        P& painter, \
+        const std::vector<std::string>& columns, \
+        const std::vector<std::string>& rows, \
+        const TableCells& cells);
+
+INSTANTIATE_DRAWING(Painter)
+INSTANTIATE_DRAWING(TikzPainter)
+INSTANTIATE_DRAWING(SVGPainter)
+INSTANTIATE_DRAWING(RecordingPainter)
@@ -1,4 +1,5 @@
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -18,3 +19,22 @@ std::vector<std::string> split(const std::string& s, char delimiter) {
     }
     return tokens;
 }
+
+float parseFloat(std::string floatValue) {
+    return std::stof(floatValue);
+}
+
+bool parseBool(std::string boolValue) {
+    if (boolValue == "+") {
+        return true;
+    }
+    if (boolValue == "-") {
+        return false;
+    }
+    throw std::invalid_argument(
+        "Unknown Boolean value: `" + boolValue + "`, should be `+` or `-`.");
+}
+
+size_t combineHash(size_t seed, size_t hash) {
+    return seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
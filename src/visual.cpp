@@ -1,99 +1,349 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <unistd.h>
 
 #include "geometry.hpp"
+#include "pipeline.hpp"
+#include "util.hpp"
 #include "visual.hpp"
 
-// TikZ.
+/*
+ * Primitive as glyph hashes see it: geometry hash, settings, text, and points
+ * rounded to grid units. Lines and curves take the lexicographically smaller
+ * direction, points of invisible primitives are ignored. Without style,
+ * settings and text are left empty, as in `getGeometryHash`.
+ */
+using PrimitiveKey = std::tuple<
+    size_t,
+    std::string,
+    std::string,
+    std::vector<std::pair<int, int>>>;
+
+static PrimitiveKey getPrimitiveKey(const Primitive& primitive, bool useStyle) {
 
-TikzPainter::TikzPainter(std::string path) {
+    std::vector<std::pair<int, int>> points;
+    if (primitive.settings != "draw=none") {
+        for (unsigned i = 0; i < primitive.pointCount; i++) {
+            GridVector point = GridVector::fromVector(primitive.points[i]);
+            points.emplace_back(point.x, point.y);
+        }
+    }
+    if (primitive.type == PrimitiveType::Line
+        or primitive.type == PrimitiveType::Curve) {
+        std::vector<std::pair<int, int>> backward(
+            points.rbegin(), points.rend());
+        points = std::min(points, backward);
+    }
+    return {
+        primitive.settings != "draw=none"
+            ? primitive.getGeometryHash()
+            : static_cast<size_t>(primitive.type),
+        useStyle ? primitive.settings : "",
+        useStyle ? primitive.text : "",
+        points};
 }
 
-std::string TikzPainter::getString() {
-    return stream.str();
+/* Sorted keys of the primitives, invisible ones are skipped without style. */
+static std::vector<PrimitiveKey>
+getPrimitiveKeys(const std::vector<Primitive>& primitives, bool useStyle) {
+
+    std::vector<PrimitiveKey> keys;
+    for (const Primitive& primitive : primitives) {
+        if (useStyle or primitive.settings != "draw=none") {
+            keys.push_back(getPrimitiveKey(primitive, useStyle));
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
 }
 
-void TikzPainter::end() {
+bool isSameGeometry(
+    const std::vector<Primitive>& primitives1,
+    const std::vector<Primitive>& primitives2) {
+    return getPrimitiveKeys(primitives1, false)
+        == getPrimitiveKeys(primitives2, false);
+}
+
+/*
+ * Check whether glyphs have the same primitives in any order, matching
+ * `getGlyphHash`.
+ */
+static bool isSameGlyph(
+    const std::vector<Primitive>& glyph1,
+    const std::vector<Primitive>& glyph2) {
+    return glyph1.size() == glyph2.size()
+        and getPrimitiveKeys(glyph1, true) == getPrimitiveKeys(glyph2, true);
 }
 
-/* Draw line between two points. */
-void TikzPainter::line(Vector point1, Vector point2, std::string settings) {
+std::pair<std::string, bool>
+GlyphDefinitions::define(const std::vector<Primitive>& primitives) {
+
+    size_t hash = getGlyphHash(primitives);
+    std::vector<std::vector<Primitive>>& sameHash = glyphs[hash];
+    std::ostringstream id;
+    id << "g" << std::hex << hash;
 
-    stream << "\\draw[" << settings << "] (" << point1.x << ", " << point1.y
-           << ") -- " << "(" << point2.x << ", " << point2.y << ");"
-           << std::endl;
+    // Glyphs with colliding hashes are numbered in the order of definition.
+    for (size_t i = 0; i < sameHash.size(); i++) {
+        if (isSameGlyph(sameHash[i], primitives)) {
+            if (i > 0) {
+                id << "-" << i;
+            }
+            return {id.str(), false};
+        }
+    }
+    if (not sameHash.empty()) {
+        id << "-" << sameHash.size();
+    }
+    sameHash.push_back(primitives);
+    return {id.str(), true};
 }
 
-/* Draw cubic Bezier curve (with 2 control points). */
-void TikzPainter::curve(
-    Vector point1,
-    Vector point2,
-    Vector point3,
-    Vector point4,
-    std::string settings) {
+bool GlyphDefinitions::empty() const {
+    return glyphs.empty();
+}
+
+void Painter::glyph(Vector position, const std::vector<Primitive>& primitives) {
+    for (const Primitive& primitive : primitives) {
+        primitive.draw(*this, position);
+    }
+}
 
-    stream << "\\draw[" << settings << "] (" << point1.x << ", " << point1.y
-           << ") .. " << "controls (" << point2.x << ", " << point2.y << ") "
-           << "and (" << point3.x << ", " << point3.y << ") .. "
-           << "(" << point4.x << ", " << point4.y << ");" << std::endl;
+std::string
+Painter::defineStyle(const std::string& name, const std::string& settings) {
+    return settings;
 }
 
-/* Draw text. */
-void TikzPainter::text(Vector center, std::string text, std::string settings) {
-    stream << "\\node[" << settings << "] at (" << center.x << ", " << center.y
-           << ") {" << text << "};" << std::endl;
+PainterStyle::PainterStyle(std::vector<std::string> descriptions) {
+    for (std::string description : descriptions) {
+
+        if (description.find('=') == std::string::npos) {
+            continue;
+        }
+        std::vector<std::string> keyValue = split(description, '=');
+        std::string key = keyValue[0];
+        std::string value = keyValue[1];
+
+        if (key == "f") {
+            format = value;
+        } else if (key == "d") {
+            deduplicate = parseBool(value);
+        } else if (key == "pipe") {
+            pipeline = parseBool(value);
+        }
+    }
+}
+
+Painter* createPainter(PainterStyle style) {
+    if (style.pipeline) {
+        if (style.deduplicate) {
+            throw std::invalid_argument(
+                "Glyph deduplication is not supported in pipelined mode.");
+        }
+        return new PipelinePainter(style.format, STDOUT_FILENO);
+    }
+    if (style.format == "tikz") {
+        return new TikzPainter("", style.deduplicate);
+    }
+    if (style.format == "svg") {
+        return new SVGPainter("", style.deduplicate);
+    }
+    throw std::invalid_argument(
+        "Unknown format: `" + style.format + "`, should be `tikz` or `svg`.");
 }
 
-/* Draw axes aligned rectangle. */
-void TikzPainter::rectangle(
-    Vector point1, Vector point2, std::string settings) {
-    stream << "\\draw[" << settings << "] (" << point1.x << ", " << point1.y
-           << ") rectangle (" << point2.x << ", " << point2.y << ");"
-           << std::endl;
+// TikZ.
+
+TikzPainter::TikzPainter(std::string path, bool deduplicate)
+    : deduplicate(deduplicate) {
+}
+
+std::string TikzPainter::getString() {
+    return definitions.str() + code;
+}
+
+void TikzPainter::end() {
+}
+
+/* Define glyph as a pic if it is new, and draw the pic. */
+void TikzPainter::glyph(
+    Vector position, const std::vector<Primitive>& primitives) {
+
+    if (not deduplicate) {
+        for (const Primitive& primitive : primitives) {
+            primitive.draw(*this, position);
+        }
+        return;
+    }
+    auto [id, isNew] = definedGlyphs.define(primitives);
+
+    if (isNew) {
+        TikzPainter body("");
+        for (const Primitive& primitive : primitives) {
+            primitive.draw(body);
+        }
+        definitions << "\\tikzset{" << id << "/.pic={" << std::endl
+                    << body.getString() << "}}" << std::endl;
+    }
+    writeCode(
+        code, "\\pic at (", position.x, ", ", position.y, ") {", id, "};\n");
+}
+
+std::string TikzPainter::defineStyle(
+    const std::string& name, const std::string& settings) {
+    definitions << "\\tikzset{" << name << "/.style={" << settings << "}}"
+                << std::endl;
+    return name;
 }
 
 // SVG.
 
-SVGPainter::SVGPainter(std::string path) {
+SVGPainter::SVGPainter(std::string path, bool deduplicate)
+    : deduplicate(deduplicate) {
 }
 
 std::string SVGPainter::getString() {
-    return stream.str();
+    if (definedGlyphs.empty()) {
+        return code;
+    }
+    return "<defs>\n" + definitions.str() + "</defs>\n" + code;
 }
 
 void SVGPainter::end() {
 }
 
-/* Draw line between two points. */
-void SVGPainter::line(Vector point1, Vector point2, std::string settings) {
+/* Define glyph as a symbol if it is new, and use the symbol. */
+void SVGPainter::glyph(
+    Vector position, const std::vector<Primitive>& primitives) {
+
+    if (not deduplicate) {
+        for (const Primitive& primitive : primitives) {
+            primitive.draw(*this, position);
+        }
+        return;
+    }
+    auto [id, isNew] = definedGlyphs.define(primitives);
+
+    if (isNew) {
+        SVGPainter body("");
+        for (const Primitive& primitive : primitives) {
+            primitive.draw(body);
+        }
+        definitions << "<symbol id=\"" << id << "\" overflow=\"visible\">"
+                    << std::endl
+                    << body.getString() << "</symbol>" << std::endl;
+    }
+    writeCode(
+        code,
+        "<use href=\"#",
+        id,
+        "\" x=\"",
+        position.x,
+        "\" y=\"",
+        position.y,
+        "\" />\n");
+}
+
+// Primitives.
+
+/* Hash of the point coordinates rounded to grid fixed-point units. */
+static size_t getPointsHash(const Vector* points, int count, int step) {
+    size_t hash = 0;
+    for (int i = 0; i < count; i++) {
+        GridVector point = GridVector::fromVector(points[i * step]);
+        hash = combineHash(hash, std::hash<GridVector> {}(point));
+    }
+    return hash;
+}
+
+size_t Primitive::getGeometryHash() const {
+
+    int count = pointCount;
+    size_t forward = getPointsHash(points, count, 1);
+    size_t hash = static_cast<size_t>(type);
+
+    if (type == PrimitiveType::Line or type == PrimitiveType::Curve) {
+        size_t backward = getPointsHash(points + count - 1, count, -1);
+        return combineHash(hash, std::min(forward, backward));
+    }
+    return combineHash(hash, forward);
+}
+
+size_t getGeometryHash(const std::vector<Primitive>& primitives) {
+
+    std::vector<size_t> hashes;
+    for (const Primitive& primitive : primitives) {
+        if (primitive.settings != "draw=none") {
+            hashes.push_back(primitive.getGeometryHash());
+        }
+    }
+    std::sort(hashes.begin(), hashes.end());
 
-    stream << "<line \"" << point1.x << "\" y1=\"" << point1.y << "\" x2=\""
-           << point2.x << "\" y2=\"" << point2.y << "\" />" << std::endl;
+    size_t hash = 0;
+    for (size_t primitiveHash : hashes) {
+        hash = combineHash(hash, primitiveHash);
+    }
+    return hash;
 }
 
-/* Draw cubic Bezier curve (with 2 control points). */
-void SVGPainter::curve(
+size_t getGlyphHash(const std::vector<Primitive>& primitives) {
+
+    std::vector<size_t> hashes;
+    for (const Primitive& primitive : primitives) {
+        hashes.push_back(std::hash<std::string> {}(primitive.settings));
+    }
+    std::sort(hashes.begin(), hashes.end());
+
+    size_t hash = getGeometryHash(primitives);
+    for (size_t settingsHash : hashes) {
+        hash = combineHash(hash, settingsHash);
+    }
+    return hash;
+}
+
+// Recording.
+
+RecordingPainter::RecordingPainter() {
+}
+
+std::string RecordingPainter::getString() {
+    return "";
+}
+
+void RecordingPainter::end() {
+}
+
+void RecordingPainter::line(
+    Vector point1, Vector point2, const std::string& settings) {
+    primitives.push_back(
+        {PrimitiveType::Line, {point1, point2}, 2, settings, ""});
+}
+
+void RecordingPainter::curve(
     Vector point1,
     Vector point2,
     Vector point3,
     Vector point4,
-    std::string settings) {
-
-    stream << "<path d=\"M " << point1.x << " " << point1.y << "C " << point2.x
-           << " " << point2.y << ", " << point3.x << " " << point3.y << ", "
-           << point4.x << " " << point4.y << "\" />" << std::endl;
+    const std::string& settings) {
+    primitives.push_back(
+        {PrimitiveType::Curve,
+         {point1, point2, point3, point4},
+         4,
+         settings,
+         ""});
 }
 
-/* Draw text. */
-void SVGPainter::text(Vector center, std::string text, std::string settings) {
-    stream << "<text x=\"" << center.x << "\" y=\"" << center.y << "\">" << text
-           << "</text>" << std::endl;
+void RecordingPainter::text(
+    Vector center, const std::string& text, const std::string& settings) {
+    primitives.push_back({PrimitiveType::Text, {center}, 1, settings, text});
 }
 
-/* Draw axes aligned rectangle. */
-void SVGPainter::rectangle(Vector point1, Vector point2, std::string settings) {
-    stream << "<rect x=\"" << point1.x << "\" y=\"" << point1.y << "\" width=\""
-           << (point2.x - point1.x) << "\" height=\"" << (point2.y - point1.x)
-           << "\" />" << std::endl;
+void RecordingPainter::rectangle(
+    Vector point1, Vector point2, const std::string& settings) {
+    primitives.push_back(
+        {PrimitiveType::Rectangle, {point1, point2}, 2, settings, ""});
 }
@@ -0,0 +1,340 @@
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "filter.hpp"
+#include "util.hpp"
+#include "visual.hpp"
+#include "watch.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+std::set<std::string> TableSpec::getFeatures() const {
+
+    std::set<std::string> features;
+
+    for (const std::vector<std::string>* parameters : {&rows, &columns}) {
+        for (std::string parameter : *parameters) {
+            for (std::string feature : split(parameter, ';')) {
+                features.insert(feature);
+            }
+        }
+    }
+    return features;
+}
+
+std::set<std::string> TableSpec::getCellKeys() const {
+
+    std::set<std::string> keys;
+
+    for (std::string row : rows) {
+        for (std::string column : columns) {
+            keys.insert(sortParameters(column + ";" + row));
+        }
+    }
+    return keys;
+}
+
+std::vector<TableSpec> parseTableSpecs(const std::string& path) {
+
+    std::ifstream inFile(path);
+
+    if (not inFile.is_open()) {
+        throw std::invalid_argument("Could not open the file " + path + ".");
+    }
+    std::vector<TableSpec> specs;
+    std::string line;
+
+    while (std::getline(inFile, line)) {
+        std::vector<std::string> parts = split(line, ' ');
+        if (parts.empty() or parts[0][0] == '#') {
+            continue;
+        }
+        if (parts.size() < 4) {
+            throw std::invalid_argument(
+                "Table specification should have output, rows, columns, and "
+                "filter: `"
+                + line + "`.");
+        }
+        TableSpec spec;
+        spec.output = parts[0];
+        spec.rows = split(parts[1], ',');
+        spec.columns = split(parts[2], ',');
+        spec.filter = split(parts[3], ',');
+        spec.options.assign(parts.begin() + 4, parts.end());
+        specs.push_back(spec);
+    }
+    return specs;
+}
+
+std::set<std::string> getChangedFeatures(
+    const std::unordered_map<std::string, std::vector<std::string>>& oldGraphs,
+    const std::unordered_map<std::string, std::vector<std::string>>&
+        newGraphs) {
+
+    std::set<std::string> features;
+
+    for (auto& [feature, descriptors] : oldGraphs) {
+        auto it = newGraphs.find(feature);
+        if (it == newGraphs.end() or it->second != descriptors) {
+            features.insert(feature);
+        }
+    }
+    for (auto& [feature, descriptors] : newGraphs) {
+        if (not oldGraphs.contains(feature)) {
+            features.insert(feature);
+        }
+    }
+    return features;
+}
+
+std::set<std::string>
+getChangedCells(const IpaSymbols& oldSymbols, const IpaSymbols& newSymbols) {
+
+    const std::unordered_map<std::string, std::string>& oldCells
+        = oldSymbols.getSymbols();
+    const std::unordered_map<std::string, std::string>& newCells
+        = newSymbols.getSymbols();
+    std::set<std::string> keys;
+
+    for (auto& [key, ipaSymbol] : oldCells) {
+        auto it = newCells.find(key);
+        if (it == newCells.end() or it->second != ipaSymbol) {
+            keys.insert(key);
+        }
+    }
+    for (auto& [key, ipaSymbol] : newCells) {
+        if (not oldCells.contains(key)) {
+            keys.insert(key);
+        }
+    }
+    return keys;
+}
+
+#ifdef __linux__
+
+static bool intersects(
+    const std::set<std::string>& set1, const std::set<std::string>& set2) {
+    for (const std::string& value : set1) {
+        if (set2.contains(value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Absolute path to compare paths of events with watched paths. */
+static std::string normalize(const std::filesystem::path& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+/* Render the table and replace its output file. */
+static void renderTable(
+    const TableSpec& spec,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    IpaSymbols* ipaSymbols) {
+
+    Clock::time_point start = Clock::now();
+
+    // Pipelined painter writes to the standard output, not to the file.
+    PainterStyle style(spec.options);
+    style.pipeline = false;
+    std::string output;
+    visitPainter(style, [&](auto& painter) {
+        drawTable(
+            painter,
+            spec.rows,
+            spec.columns,
+            spec.filter,
+            ipaSymbols,
+            graphs);
+        painter.end();
+        output = painter.getString();
+    });
+
+    // Viewers never see a partially written file.
+    std::string temporaryPath = spec.output + ".tmp";
+    std::ofstream file(temporaryPath);
+    file << output;
+    file.close();
+    if (file.fail()) {
+        throw std::invalid_argument("Could not write the file " + spec.output);
+    }
+    std::filesystem::rename(temporaryPath, spec.output);
+
+    std::cerr << "Rendered " << spec.output << " in " << std::fixed
+              << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(
+                     Clock::now() - start)
+                     .count()
+              << " ms." << std::endl;
+}
+
+/* Render the table, report errors without stopping. */
+static void tryRenderTable(
+    const TableSpec& spec,
+    const std::unordered_map<std::string, std::vector<std::string>>& graphs,
+    IpaSymbols* ipaSymbols) {
+    try {
+        renderTable(spec, graphs, ipaSymbols);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+/*
+ * Wait for written or replaced files, collect events until there are none
+ * for a short time, so that one save is handled once.
+ */
+static std::set<std::string> waitForChanges(
+    int inotify, const std::map<int, std::string>& directories) {
+
+    const int QUIET_TIME_MS = 30;
+    alignas(inotify_event) char buffer[1 << 14];
+    std::set<std::string> paths;
+
+    pollfd descriptor {inotify, POLLIN, 0};
+    int timeout = -1;
+
+    while (poll(&descriptor, 1, timeout) > 0) {
+        ssize_t length = read(inotify, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (char* pointer = buffer; pointer < buffer + length;) {
+            inotify_event* event = reinterpret_cast<inotify_event*>(pointer);
+            if (event->len > 0 and directories.contains(event->wd)) {
+                paths.insert(normalize(
+                    std::filesystem::path(directories.at(event->wd))
+                    / event->name));
+            }
+            pointer += sizeof(inotify_event) + event->len;
+        }
+        timeout = QUIET_TIME_MS;
+    }
+    return paths;
+}
+
+void watch(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const std::string& specPath) {
+
+    std::unordered_map<std::string, std::vector<std::string>> graphs
+        = parseGraphs(graphsPath);
+    std::unique_ptr<IpaSymbols> ipaSymbols(parseTables(tablesPath));
+    std::vector<TableSpec> specs = parseTableSpecs(specPath);
+
+    for (const TableSpec& spec : specs) {
+        tryRenderTable(spec, graphs, ipaSymbols.get());
+    }
+
+    int inotify = inotify_init1(IN_CLOEXEC);
+    if (inotify < 0) {
+        throw std::invalid_argument(
+            std::string("Could not start watching: ") + std::strerror(errno));
+    }
+
+    // Watch directories, because editors often replace files instead of
+    // writing them.
+    std::map<int, std::string> directories;
+    for (std::string path : {graphsPath, tablesPath, specPath}) {
+        std::filesystem::path directory
+            = std::filesystem::path(path).parent_path();
+        if (directory.empty()) {
+            directory = std::filesystem::current_path();
+        }
+        int descriptor = inotify_add_watch(
+            inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (descriptor < 0) {
+            throw std::invalid_argument(
+                "Could not watch the directory " + directory.string() + ".");
+        }
+        directories[descriptor] = directory.string();
+    }
+    std::cerr << "Watching " << graphsPath << ", " << tablesPath << ", and "
+              << specPath << "." << std::endl;
+
+    // Paths changed since the last successful update: if a file can't be
+    // parsed, e.g. while it is being written, the previous state is kept and
+    // all changes are applied at the next successful update.
+    std::set<std::string> paths;
+
+    while (true) {
+        paths.merge(waitForChanges(inotify, directories));
+
+        bool isGraphsChanged = paths.contains(normalize(graphsPath));
+        bool isTablesChanged = paths.contains(normalize(tablesPath));
+        bool isSpecChanged = paths.contains(normalize(specPath));
+
+        // Parse all changed files before replacing any state.
+        std::unordered_map<std::string, std::vector<std::string>> newGraphs;
+        std::unique_ptr<IpaSymbols> newSymbols;
+        std::vector<TableSpec> newSpecs;
+        try {
+            if (isGraphsChanged) {
+                newGraphs = parseGraphs(graphsPath);
+            }
+            if (isTablesChanged) {
+                newSymbols.reset(parseTables(tablesPath));
+            }
+            if (isSpecChanged) {
+                newSpecs = parseTableSpecs(specPath);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            continue;
+        }
+        paths.clear();
+
+        std::set<std::string> features;
+        std::set<std::string> cells;
+        if (isGraphsChanged) {
+            features = getChangedFeatures(graphs, newGraphs);
+            graphs = std::move(newGraphs);
+        }
+        if (isTablesChanged) {
+            cells = getChangedCells(*ipaSymbols, *newSymbols);
+            ipaSymbols = std::move(newSymbols);
+        }
+        if (isSpecChanged) {
+            specs = std::move(newSpecs);
+        }
+
+        if (not features.empty()) {
+            std::cerr << "Changed features:";
+            for (std::string feature : features) {
+                std::cerr << " " << feature;
+            }
+            std::cerr << "." << std::endl;
+        }
+        for (const TableSpec& spec : specs) {
+            if (isSpecChanged or intersects(spec.getFeatures(), features)
+                or intersects(spec.getCellKeys(), cells)) {
+                tryRenderTable(spec, graphs, ipaSymbols.get());
+            }
+        }
+    }
+}
+
+#else
+
+void watch(
+    const std::string& graphsPath,
+    const std::string& tablesPath,
+    const std::string& specPath) {
+    throw std::invalid_argument("Watch mode is supported on Linux only.");
+}
+
+#endif